@@ -0,0 +1,167 @@
+// bench/mlab_bench.cpp — Microbenchmarks for the interpreter hot paths.
+// Built via the MLAB_BUILD_BENCH option; reports ns/op and bytes
+// allocated through the engine allocator so perf regressions show up as
+// numbers instead of production incidents.
+
+#include "MLabEngine.hpp"
+#include "MLabLexer.hpp"
+#include "MLabParser.hpp"
+#include "MLabStdLibrary.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <string>
+
+using namespace mlab;
+
+namespace {
+
+struct AllocStats
+{
+    size_t count = 0;
+    size_t bytes = 0;
+};
+
+AllocStats g_alloc;
+
+Allocator countingAllocator()
+{
+    return {[](size_t n) -> void * {
+                g_alloc.count++;
+                g_alloc.bytes += n;
+                return ::operator new(n);
+            },
+            [](void *p, size_t) { ::operator delete(p); }};
+}
+
+// Runs fn repeatedly until ~0.2 s elapses, then reports ns/op and the
+// allocator traffic per op.
+void bench(const char *name, const std::function<void()> &fn)
+{
+    using Clock = std::chrono::steady_clock;
+
+    fn(); // warm-up (also populates caches the production path would hit)
+
+    size_t iters = 1;
+    double elapsedNs = 0;
+    for (;;) {
+        g_alloc = {};
+        auto t0 = Clock::now();
+        for (size_t i = 0; i < iters; ++i)
+            fn();
+        elapsedNs = std::chrono::duration<double, std::nano>(Clock::now() - t0).count();
+        if (elapsedNs >= 2e8 || iters >= (size_t(1) << 24))
+            break;
+        iters *= 4;
+    }
+
+    std::printf("%-34s %12.1f ns/op %10.1f B/op   (%zu iters)\n",
+                name,
+                elapsedNs / static_cast<double>(iters),
+                static_cast<double>(g_alloc.bytes) / static_cast<double>(iters),
+                iters);
+}
+
+Engine *makeEngine()
+{
+    auto *engine = new Engine();
+    engine->setAllocator(countingAllocator());
+    StdLibrary::install(*engine);
+    engine->setOutputFunc([](const std::string &) {});
+    return engine;
+}
+
+} // namespace
+
+int main()
+{
+    std::printf("MLab microbenchmarks\n");
+    std::printf("====================\n");
+
+    // ── Front end ──
+    std::string script;
+    for (int i = 0; i < 200; ++i)
+        script += "x" + std::to_string(i) + " = " + std::to_string(i) + " * 2 + 1; % c\n";
+
+    bench("lexer: tokenize 200 lines", [&] {
+        Lexer lexer(script);
+        auto tokens = lexer.tokenize();
+    });
+
+    bench("parser: parse 200 lines", [&] {
+        Lexer lexer(script);
+        auto tokens = lexer.tokenize();
+        Parser parser(tokens);
+        auto ast = parser.parse();
+    });
+
+    // ── Engine loop throughput ──
+    {
+        Engine *e = makeEngine();
+        bench("eval: 1k-iter scalar loop", [&] {
+            e->eval("s = 0; for i = 1:1000 s = s + i * 2 - 1; end");
+        });
+        delete e;
+    }
+
+    {
+        Engine *e = makeEngine();
+        e->setExecutionMode(ExecutionMode::BYTECODE);
+        bench("eval: 1k-iter loop (bytecode)", [&] {
+            e->eval("s = 0; for i = 1:1000 s = s + i * 2 - 1; end");
+        });
+        delete e;
+    }
+
+    // ── Elementwise kernels ──
+    {
+        Engine *e = makeEngine();
+        e->eval("a = rand(1, 100000); b = rand(1, 100000);");
+        bench("elementwise: 100k add", [&] { e->eval("c = a + b;"); });
+        bench("elementwise: 100k mul bcast", [&] { e->eval("c = a .* 3;"); });
+        bench("compare: 100k mask", [&] { e->eval("m = a > 0.5;"); });
+        delete e;
+    }
+
+    // ── Matmul ──
+    {
+        Engine *e = makeEngine();
+        e->eval("A = rand(100); B = rand(100);");
+        bench("matmul: 100x100", [&] { e->eval("C = A * B;"); });
+        delete e;
+    }
+
+    // ── Indexing ──
+    {
+        Engine *e = makeEngine();
+        e->eval("v = rand(1, 10000); k = 5000; M = rand(100);");
+        bench("index: scalar v(k)", [&] { e->eval("x = v(k);"); });
+        bench("index: range v(1:100)", [&] { e->eval("x = v(1:100);"); });
+        bench("index: logical mask", [&] { e->eval("x = v(v > 0.99);"); });
+        bench("index: column M(:, 7)", [&] { e->eval("x = M(:, 7);"); });
+        delete e;
+    }
+
+    // ── Struct / cell access ──
+    {
+        Engine *e = makeEngine();
+        e->eval("s.alpha = 1; s.beta = 2; s.gamma = 3; c = {1, 'two', [3 4]};");
+        bench("struct: field get+set", [&] { e->eval("s.beta = s.beta + 1;"); });
+        bench("cell: element get", [&] { e->eval("x = c{3};"); });
+        delete e;
+    }
+
+    // ── Call overhead ──
+    {
+        Engine *e = makeEngine();
+        e->eval("function r = ident(x)\n r = x;\nend");
+        e->eval("h = @(x) x;");
+        bench("call: user function", [&] { e->eval("y = ident(1);"); });
+        bench("call: anon handle", [&] { e->eval("y = h(1);"); });
+        bench("call: fast builtin sin", [&] { e->eval("y = sin(1);"); });
+        delete e;
+    }
+
+    return 0;
+}
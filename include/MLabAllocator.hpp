@@ -3,6 +3,8 @@
 
 #include <cstddef>
 #include <functional>
+#include <mutex>
+#include <vector>
 
 namespace mlab {
 
@@ -14,7 +16,89 @@ struct Allocator
     AllocFn allocate;
     DeallocFn deallocate;
 
+    // Non-type-erased fast path: when set, DataBuffer invokes these raw
+    // pointers directly instead of going through std::function. The
+    // std::function members remain for ad-hoc lambda allocators.
+    void *(*allocateFast)(void *ctx, size_t bytes) = nullptr;
+    void (*deallocateFast)(void *ctx, void *p, size_t bytes) = nullptr;
+    void *ctx = nullptr;
+
     static Allocator defaultAllocator();
 };
 
+// Size-classed pool for the small DataBuffers that dominate interpreter
+// traffic. Freed chunks go onto per-class free lists and are reused
+// without touching the system allocator; sizes above the largest class
+// fall through to operator new. Thread-safe (kernels may allocate from
+// workers), slabs are returned wholesale on destruction.
+class PoolAllocator
+{
+public:
+    PoolAllocator() = default;
+    ~PoolAllocator();
+
+    PoolAllocator(const PoolAllocator &) = delete;
+    PoolAllocator &operator=(const PoolAllocator &) = delete;
+
+    // Adapter handing this pool to an Engine (or DataBuffer) via the
+    // fast-path pointers. The pool must outlive every buffer allocated
+    // through it.
+    Allocator allocator();
+
+    size_t slabCount() const;
+
+private:
+    static constexpr size_t kClassSizes[5] = {16, 32, 64, 128, 256};
+    static constexpr size_t kSlabBytes = 4096;
+
+    struct FreeNode
+    {
+        FreeNode *next;
+    };
+
+    FreeNode *freeLists_[5] = {nullptr, nullptr, nullptr, nullptr, nullptr};
+    std::vector<void *> slabs_;
+    mutable std::mutex mutex_;
+
+    static int classFor(size_t bytes);
+    void *allocate(size_t bytes);
+    void deallocate(void *p, size_t bytes);
+};
+
+// Bump allocator for host-scoped temporary workspaces: allocation is a
+// pointer increment, deallocation is a no-op, and reset() releases
+// everything wholesale. Values allocated from an arena must not outlive
+// the next reset — Engine variables persist across eval calls, so scope
+// an arena-backed Engine (or the values you keep) accordingly.
+class ArenaAllocator
+{
+public:
+    explicit ArenaAllocator(size_t blockBytes = 64 * 1024);
+    ~ArenaAllocator();
+
+    ArenaAllocator(const ArenaAllocator &) = delete;
+    ArenaAllocator &operator=(const ArenaAllocator &) = delete;
+
+    Allocator allocator();
+
+    // Frees every block except the first and rewinds the bump pointer.
+    void reset();
+
+    size_t bytesAllocated() const;
+
+private:
+    struct Block
+    {
+        char *data;
+        size_t capacity;
+    };
+
+    std::vector<Block> blocks_;
+    size_t blockBytes_;
+    size_t offset_ = 0;   // into the last block
+    size_t totalUsed_ = 0;
+
+    void *allocate(size_t bytes);
+};
+
 } // namespace mlab
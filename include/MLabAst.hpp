@@ -40,11 +40,27 @@ enum class NodeType {
     GLOBAL_STMT,
     PERSISTENT_STMT,
     DELETE_ASSIGN,
+
+    NODE_TYPE_COUNT, // keep last — sized the profiler counter table
 };
 
+const char *nodeTypeName(NodeType t);
+
 struct ASTNode;
 using ASTNodePtr = std::unique_ptr<ASTNode>;
 
+// Prepared closure info for an ANON_FUNC node: the wrapped body is built
+// and slot-resolved once and then shared immutably by every handle the
+// node produces; freeVars lists the names the body actually references,
+// so handle creation captures those instead of snapshotting the whole
+// environment chain.
+struct AnonFuncInfo
+{
+    std::shared_ptr<const ASTNode> body;
+    std::vector<std::string> freeVars;
+    int slotCount = 0;
+};
+
 struct ASTNode
 {
     NodeType type;
@@ -56,6 +72,20 @@ struct ASTNode
     bool boolValue = false;
     bool suppressOutput = false;
 
+    // Variable slot assigned by SlotResolver (-1 = unresolved; the
+    // engine falls back to name lookup through the Environment).
+    int slot = -1;
+
+    // Interned field-name id for FIELD_ACCESS nodes (-1 = unresolved).
+    int fieldId = -1;
+
+    // Direct-dispatch builtin id for CALL nodes (-1 = unresolved).
+    int builtinId = -1;
+
+    // Lazily built by the engine for ANON_FUNC nodes; not cloned.
+    mutable std::shared_ptr<const AnonFuncInfo> anonInfo;
+
+
     std::vector<ASTNodePtr> children;
     std::vector<std::string> paramNames;
     std::vector<std::string> returnNames;
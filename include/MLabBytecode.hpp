@@ -0,0 +1,110 @@
+// include/MLabBytecode.hpp
+#pragma once
+
+#include "MLabAst.hpp"
+#include "MLabValue.hpp"
+
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace mlab {
+
+class Engine;
+
+using BinaryOpFunc = std::function<MValue(const MValue &, const MValue &)>;
+using UnaryOpFunc = std::function<MValue(const MValue &)>;
+
+// Flat bytecode representation compiled from the ASTNode tree.
+// Covers the scalar/loop-heavy core of the language (literals,
+// identifiers, registered binary/unary operators, if/while and
+// colon-range for loops). Anything else fails compilation and the
+// tree walker is used as fallback.
+enum class OpCode {
+    PUSH_CONST,        // a: constant index → push
+    LOAD_VAR,          // a: name index → push variable (or zero-arg builtin)
+    STORE_VAR,         // a: name index; pop value, store, keep as last value
+    STORE_VAR_DISPLAY, // like STORE_VAR but also displays the value
+    SET_ANS_DISPLAY,   // peek; set 'ans' and display
+    POP_TO_LAST,       // pop into the last-value register
+    POP,               // pop and discard
+    BINARY_OP,         // a: resolved binary op index; pop rhs, lhs → push result
+    UNARY_OP,          // a: resolved unary op index; pop operand → push result
+    JUMP,              // a: target instruction
+    JUMP_IF_FALSE,     // a: target; pop condition (toBool)
+    PUSH_TRUE,         // push logical true
+    PUSH_FALSE,        // push logical false
+    TO_LOGICAL,        // pop; push logicalScalar(toBool)
+    FOR_RANGE_INIT,    // a: loop slot, b: name index, c: jump-if-empty target;
+                       // pops stop, step, start
+    FOR_RANGE_NEXT,    // a: loop slot, b: name index, c: loop body target
+};
+
+struct Instr
+{
+    OpCode op;
+    int a = 0;
+    int b = 0;
+    int c = 0;
+    int d = 0; // FOR_RANGE_*: loop variable slot (-1 = unresolved)
+};
+
+struct BytecodeChunk
+{
+    std::vector<Instr> code;
+    std::vector<MValue> constants;
+    std::vector<std::string> names;
+    std::vector<const BinaryOpFunc *> binaryOps;
+    std::vector<const UnaryOpFunc *> unaryOps;
+    int numLoopSlots = 0;
+};
+
+// Compiles an AST into a BytecodeChunk. Returns false (leaving the
+// chunk unusable) when the tree contains a construct the VM does not
+// cover yet; the caller then falls back to Engine::execNode.
+class BytecodeCompiler
+{
+public:
+    static bool compile(const ASTNode *root, const Engine &engine, BytecodeChunk &out);
+
+private:
+    explicit BytecodeCompiler(const Engine &engine, BytecodeChunk &chunk)
+        : engine_(engine)
+        , chunk_(chunk)
+    {}
+
+    struct Unsupported
+    {};
+
+    struct LoopContext
+    {
+        int slot = -1;                   // -1 for while loops
+        int continueTarget = 0;          // patched for for-loops
+        std::vector<size_t> breakJumps;  // JUMP instrs to patch to loop end
+        std::vector<size_t> continueJumps;
+    };
+
+    const Engine &engine_;
+    BytecodeChunk &chunk_;
+    std::vector<LoopContext> loopStack_;
+    int maxLoopDepth_ = 0;
+
+    size_t emit(OpCode op, int a = 0, int b = 0, int c = 0);
+    void patchTarget(size_t instrIdx, int target);
+    int here() const;
+
+    int addConstant(MValue val);
+    int addName(const std::string &name);
+    int addBinaryOp(const std::string &op);
+    int addUnaryOp(const std::string &op);
+
+    void compileStatement(const ASTNode *node);
+    void compileExpression(const ASTNode *node);
+    void compileBlock(const ASTNode *node);
+    void compileIf(const ASTNode *node);
+    void compileWhile(const ASTNode *node);
+    void compileFor(const ASTNode *node);
+    void compileShortCircuit(const ASTNode *node, bool isAnd);
+};
+
+} // namespace mlab
@@ -8,6 +8,8 @@
 #include <atomic>
 #include <functional>
 #include <memory>
+#include <mutex>
+#include <shared_mutex>
 #include <stdexcept>
 #include <string>
 #include <unordered_map>
@@ -16,9 +18,30 @@
 namespace mlab {
 
 using ExternalFunc = std::function<std::vector<MValue>(const std::vector<MValue> &)>;
+// Span-based single-return convention for hot builtins: no vector
+// construction on either side of the call.
+using FastFunc = std::function<MValue(const MValue *args, size_t nargs)>;
 using BinaryOpFunc = std::function<MValue(const MValue &, const MValue &)>;
 using UnaryOpFunc = std::function<MValue(const MValue &)>;
 
+// Thrown when another thread calls Engine::requestInterrupt(); passes
+// through try/catch blocks in user scripts.
+struct InterruptError : std::runtime_error
+{
+    InterruptError()
+        : std::runtime_error("Execution interrupted")
+    {}
+};
+
+// Thrown when the per-evaluation step budget runs out; also passes
+// through script-level try/catch.
+struct BudgetExceededError : std::runtime_error
+{
+    BudgetExceededError()
+        : std::runtime_error("Execution budget exceeded")
+    {}
+};
+
 struct BreakSignal
 {};
 struct ContinueSignal
@@ -33,12 +56,50 @@ struct UserFunction
     std::vector<std::string> returns;
     std::shared_ptr<const ASTNode> body;
     std::shared_ptr<Environment> closureEnv;
+    int slotCount = 0;
 };
 
+class Engine;
+
+// A parsed program that can be executed repeatedly without re-lexing
+// or re-parsing. The AST is shared immutably, so copies are cheap.
+// A Script is bound to the Engine that compiled it (variable slots are
+// numbered against that engine's registry).
+class Script
+{
+public:
+    Script() = default;
+
+    bool valid() const { return ast_ != nullptr; }
+
+private:
+    friend class Engine;
+
+    Script(std::shared_ptr<const ASTNode> ast, const Engine *owner)
+        : ast_(std::move(ast))
+        , owner_(owner)
+    {}
+
+    std::shared_ptr<const ASTNode> ast_;
+    const Engine *owner_ = nullptr;
+};
+
+struct BytecodeChunk;
+
+// Execution backend selection. BYTECODE compiles scripts to a flat
+// instruction stream where possible; the tree walker remains the
+// fallback for constructs the VM does not cover yet.
+enum class ExecutionMode { TREE_WALK, BYTECODE };
+
+class EngineContext;
+
 class Engine
 {
 public:
     Engine();
+    // Builds an engine that shares the context's operator tables,
+    // builtin tables and parsed user functions (see MLabEnginePool.hpp).
+    explicit Engine(std::shared_ptr<EngineContext> context);
 
     Engine(const Engine &) = delete;
     Engine &operator=(const Engine &) = delete;
@@ -51,16 +112,73 @@ public:
     void registerBinaryOp(const std::string &op, BinaryOpFunc func);
     void registerUnaryOp(const std::string &op, UnaryOpFunc func);
     void registerFunction(const std::string &name, ExternalFunc func);
+    void registerFastFunction(const std::string &name, FastFunc func);
+
+    const BinaryOpFunc *findBinaryOp(const std::string &op) const;
+    const UnaryOpFunc *findUnaryOp(const std::string &op) const;
+
+    void setExecutionMode(ExecutionMode mode);
+    ExecutionMode executionMode() const;
+
+    // Constant folding / dead-branch elimination in compile(). On by
+    // default; disable when re-registering arithmetic operators with
+    // non-standard scalar semantics.
+    void setAstOptimization(bool enabled);
+
+    // Compute x = x <op> expr into x's buffer when x is uniquely owned
+    // and shapes match, instead of allocate+copy+free. Assumes stdlib
+    // operator semantics, like the AST optimizer.
+    void setInPlaceArithmetic(bool enabled);
+
+    // Opt-in instrumentation: per-NodeType and per-builtin invocation
+    // counts and cumulative time, plus allocator traffic. Costs a single
+    // predictable branch in execNode when disabled.
+    void setProfiling(bool enabled);
+    MValue profileReport();
+    void resetProfile();
 
     void setVariable(const std::string &name, MValue val);
     MValue *getVariable(const std::string &name);
+    // Drops every workspace variable and re-seeds the standard
+    // constants; used by EnginePool between checkouts.
+    void clearWorkspace();
 
     MValue eval(const std::string &code);
 
+    // Invokes a function handle with the global environment as the call
+    // context. Public so builtins like arrayfun can re-enter the engine.
+    MValue callHandle(const MValue &handle, const std::vector<MValue> &args);
+
+    // Binary workspace persistence (see MLabSerialize.hpp for the
+    // format). save/load builtins wrap these.
+    void saveWorkspace(const std::string &path) const;
+    void loadWorkspace(const std::string &path);
+
+    Script compile(const std::string &code);
+    MValue run(const Script &script);
+
+    void setScriptCacheLimit(size_t limit);
+    void clearScriptCache();
+
+    // Cooperative time-slicing. The step budget bounds statements plus
+    // loop iterations per eval/run/evalStep call (0 = unlimited);
+    // requestInterrupt() may be called from another thread and aborts at
+    // the next statement or loop back-edge. evalStep executes one
+    // top-level statement of a compiled script per call and returns
+    // false once the script is finished, so a host can spread a script
+    // across frames.
+    void setExecBudget(uint64_t maxSteps);
+    void requestInterrupt();
+    bool evalStep(const Script &script, size_t &cursor);
+
     using OutputFunc = std::function<void(const std::string &)>;
     void setOutputFunc(OutputFunc f);
     void setMaxRecursionDepth(int depth);
 
+    // Caps how many elements displayValue prints for large arrays
+    // (MATLAB-style truncation with a "more rows" notice). Default 1000.
+    void setDisplayLimit(size_t maxElements);
+
 private:
     Allocator allocator_;
     GlobalStore globalStore_;
@@ -69,11 +187,95 @@ private:
     std::unordered_map<std::string, BinaryOpFunc> binaryOps_;
     std::unordered_map<std::string, UnaryOpFunc> unaryOps_;
     std::unordered_map<std::string, ExternalFunc> externalFuncs_;
+    // userFuncs_ can grow while parallel arrayfun workers resolve names
+    // (anonymous handles register an entry per creation), so lookups
+    // take a shared lock and inserts an exclusive one; entry addresses
+    // stay stable, so pointers remain usable after unlock.
+    mutable std::shared_mutex userFuncsMutex_;
     std::unordered_map<std::string, UserFunction> userFuncs_;
+    const UserFunction *findUserFunction(const std::string &name) const;
+    const UserFunction *storeUserFunction(const std::string &name, UserFunction &&func);
+
+    // Direct call table for span-convention builtins; CALL nodes carry
+    // the index so dispatch skips the name hash entirely.
+    std::vector<FastFunc> fastFuncs_;
+    std::unordered_map<std::string, int> fastFuncIds_;
+    int fastFunctionId(const std::string &name) const;
+
+    // Source-hash cache for eval(): repeated evaluation of the same code
+    // reuses the parsed AST instead of re-lexing and re-parsing.
+    struct CachedScript
+    {
+        std::string source;
+        std::shared_ptr<const ASTNode> ast;
+    };
+    std::unordered_map<size_t, CachedScript> scriptCache_;
+    size_t scriptCacheLimit_ = 64;
+
+    // Bytecode chunks compiled from cached ASTs, keyed by root node.
+    // The anchor keeps the AST (and thus the key) alive; compiled ==
+    // false records a program the VM cannot cover, so we do not retry.
+    struct CachedChunk
+    {
+        std::shared_ptr<const ASTNode> anchor;
+        std::shared_ptr<const BytecodeChunk> chunk;
+        bool compiled = false;
+    };
+    std::unordered_map<const ASTNode *, CachedChunk> chunkCache_;
+
+    // Per-engine inline cache for named user-function call sites. Owned
+    // by the engine (never written onto shared AST nodes, so pooled
+    // engines cannot race or observe foreign pointers); the stored name
+    // is re-checked on hit, which also defuses node-address reuse after
+    // a cached script is dropped.
+    struct CalleeEntry
+    {
+        std::string name;
+        const UserFunction *target = nullptr;
+    };
+    // The mutex guards the map itself: workers inside parallel arrayfun
+    // can first-execute a shared call site concurrently.
+    std::mutex calleeCacheMutex_;
+    std::unordered_map<const ASTNode *, CalleeEntry> calleeCache_;
+    ExecutionMode executionMode_ = ExecutionMode::TREE_WALK;
+    bool astOptimization_ = true;
+    bool inPlaceArithmetic_ = true;
+
+    // Atomics: parallel arrayfun workers may record while profiling is
+    // enabled (the map itself only grows on the interpreter thread; the
+    // counters inside existing nodes are what workers touch).
+    struct ProfileCounter
+    {
+        std::atomic<uint64_t> count{0};
+        std::atomic<uint64_t> ns{0};
+    };
+    bool profiling_ = false;
+    ProfileCounter nodeProfile_[static_cast<size_t>(NodeType::NODE_TYPE_COUNT)];
+    // profileMutex_ guards the map's shape (insert/clear/iterate);
+    // counter updates on existing nodes stay lock-free.
+    std::mutex profileMutex_;
+    std::unordered_map<std::string, ProfileCounter> builtinProfile_;
+    std::atomic<uint64_t> profileAllocCount_{0};
+    std::atomic<uint64_t> profileAllocBytes_{0};
+    Allocator unprofiledAllocator_;
+
+    // Persistent slot numbering for top-level code: the same variable
+    // name resolves to the same global slot across all scripts this
+    // engine ever compiles (see SlotResolver).
+    std::unordered_map<std::string, int> globalSlots_;
+    int globalSlotFor(const std::string &name);
 
     OutputFunc outputFunc_;
+    size_t displayLimit_ = 1000;
+    std::string displayBuffer_; // reused across displayValue calls
+    uint64_t execBudget_ = 0; // 0 = unlimited
+    // Atomic: parallel arrayfun/cellfun workers tick the same counter
+    // (the budget bounds total steps across all workers of one eval).
+    std::atomic<int64_t> stepsLeft_{0};
+    std::atomic<bool> interruptRequested_{false};
     int maxRecursionDepth_ = 500;
-    int currentRecursionDepth_ = 0;
+    // Shared across worker threads during parallel arrayfun/cellfun.
+    std::atomic<int> currentRecursionDepth_{0};
     std::atomic<int> anonCounter_{0};
 
     struct IndexContext
@@ -82,7 +284,10 @@ private:
         int dimension = 0;
         int ndims = 1;
     };
-    std::vector<IndexContext> indexContextStack_;
+    // Thread-local: each worker evaluating a handle keeps its own
+    // indexing context, and push/pop stays balanced per evaluation.
+    static thread_local std::vector<IndexContext> indexContextStack_;
+    std::shared_ptr<EngineContext> context_; // keeps shared tables alive
 
     class IndexContextGuard
     {
@@ -104,29 +309,63 @@ private:
     class RecursionGuard
     {
     public:
-        RecursionGuard(int &depth, int maxDepth)
+        RecursionGuard(std::atomic<int> &depth, int maxDepth)
             : depth_(depth)
         {
-            if (++depth_ > maxDepth)
+            if (depth_.fetch_add(1, std::memory_order_relaxed) + 1 > maxDepth) {
+                depth_.fetch_sub(1, std::memory_order_relaxed);
                 throw std::runtime_error("Maximum recursion depth (" + std::to_string(maxDepth)
                                          + ") exceeded");
+            }
         }
-        ~RecursionGuard() { --depth_; }
+        ~RecursionGuard() { depth_.fetch_sub(1, std::memory_order_relaxed); }
 
         RecursionGuard(const RecursionGuard &) = delete;
         RecursionGuard &operator=(const RecursionGuard &) = delete;
 
     private:
-        int &depth_;
+        std::atomic<int> &depth_;
     };
 
     void output(const std::string &s);
     void displayValue(const std::string &name, const MValue &val);
+    void seedConstants();
+
+    MValue execProgram(const std::shared_ptr<const ASTNode> &ast);
+    void beginExecution();
+
+    // Eagerly builds AnonFuncInfo for every ANON_FUNC node in the tree
+    // (pure AST analysis) so shared function bodies are never mutated
+    // during concurrent execution by pooled engines.
+    void prepareAnonFuncs(const ASTNode *node);
+    void prepareAnonInfo(const ASTNode *node);
+
+    // Budget/interrupt check at statement and loop-back-edge
+    // granularity: one decrement-and-test plus a relaxed atomic load.
+    inline void tick()
+    {
+        if (stepsLeft_.fetch_sub(1, std::memory_order_relaxed) <= 1)
+            onBudgetExhausted();
+        if (interruptRequested_.load(std::memory_order_relaxed)) {
+            interruptRequested_.store(false, std::memory_order_relaxed);
+            throw InterruptError();
+        }
+    }
+    void onBudgetExhausted();
+    MValue execBytecode(const BytecodeChunk &chunk, std::shared_ptr<Environment> env);
+    MValue loadIdentifier(const std::string &name, std::shared_ptr<Environment> env);
 
     MValue execNode(const ASTNode *node, std::shared_ptr<Environment> env);
+    MValue execNodeDispatch(const ASTNode *node, std::shared_ptr<Environment> env);
+    void recordBuiltinProfile(const std::string &name, uint64_t ns);
     MValue execBlock(const ASTNode *node, std::shared_ptr<Environment> env);
     MValue execIdentifier(const ASTNode *node, std::shared_ptr<Environment> env);
     MValue execAssign(const ASTNode *node, std::shared_ptr<Environment> env);
+    bool tryInPlaceAssign(const ASTNode *node,
+                          const ASTNode *lhs,
+                          const ASTNode *binop,
+                          std::shared_ptr<Environment> env,
+                          MValue &result);
     MValue execMultiAssign(const ASTNode *node, std::shared_ptr<Environment> env);
     MValue execBinaryOp(const ASTNode *node, std::shared_ptr<Environment> env);
     MValue execUnaryOp(const ASTNode *node, std::shared_ptr<Environment> env);
@@ -157,6 +396,10 @@ private:
                                      int dim,
                                      int ndims,
                                      std::shared_ptr<Environment> env);
+    std::vector<size_t> resolveIndexValue(const MValue &val,
+                                          const MValue &array,
+                                          int dim,
+                                          int ndims);
     MValue execIndexAccess(const MValue &var,
                            const ASTNode *callNode,
                            std::shared_ptr<Environment> env);
@@ -0,0 +1,54 @@
+// include/MLabEnginePool.hpp
+#pragma once
+
+#include "MLabEngine.hpp"
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace mlab {
+
+// Immutable shared engine setup for multicore script serving: the
+// context owns a prototype Engine configured once (stdlib install,
+// library scripts parsed into user functions), and every Engine built
+// from the context imports those tables by shallow copy — user function
+// ASTs are shared_ptr-shared, so nothing is re-parsed, and operator/
+// builtin std::functions are copied, not re-registered.
+//
+// The registered lambdas resolve the allocator through the prototype,
+// so context-built engines share the prototype's allocation strategy;
+// the context (and thus the prototype) outlives them by construction.
+class EngineContext
+{
+public:
+    explicit EngineContext(const std::function<void(Engine &)> &setup);
+
+    Engine &prototype() { return *prototype_; }
+    const Engine &prototype() const { return *prototype_; }
+
+private:
+    std::unique_ptr<Engine> prototype_;
+};
+
+// O(1) checkout of initialized engines. Released engines get their
+// workspace cleared and are parked for reuse; acquire() creates a fresh
+// context-built engine only when the pool is empty.
+class EnginePool
+{
+public:
+    explicit EnginePool(std::shared_ptr<EngineContext> context, size_t preallocate = 0);
+
+    std::unique_ptr<Engine> acquire();
+    void release(std::unique_ptr<Engine> engine);
+
+    size_t idleCount() const;
+
+private:
+    std::shared_ptr<EngineContext> context_;
+    std::vector<std::unique_ptr<Engine>> idle_;
+    mutable std::mutex mutex_;
+};
+
+} // namespace mlab
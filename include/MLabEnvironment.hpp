@@ -37,6 +37,15 @@ public:
     void declareGlobal(const std::string &name);
     bool isGlobal(const std::string &name) const;
 
+    // Slot-addressed fast path (see SlotResolver). Bindings cache the
+    // address of the vars_ entry for a resolved name, so slotted access
+    // is an array index instead of a string hash. Declared globals and
+    // names found only in parent scopes are never bound.
+    void reserveSlots(size_t n);
+    MValue *slotRead(int slot);
+    void slotBindLocal(int slot, const std::string &name);
+    void slotWrite(int slot, const std::string &name, MValue val);
+
     GlobalStore *globalStore() const { return globalStore_; }
 
     // Iterate over local variables only
@@ -59,6 +68,7 @@ private:
     std::unordered_set<std::string> globals_;
     std::shared_ptr<Environment> parent_;
     GlobalStore *globalStore_ = nullptr;
+    std::vector<MValue *> slotBindings_;
 };
 
 } // namespace mlab
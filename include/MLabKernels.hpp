@@ -0,0 +1,66 @@
+// include/MLabKernels.hpp
+#pragma once
+
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+
+namespace mlab {
+namespace kernels {
+
+// Elementwise double-precision kernels behind the stdlib operator layer.
+// On x86-64 an AVX2+FMA variant is selected at runtime via
+// __builtin_cpu_supports; aarch64 uses NEON, Emscripten uses wasm
+// SIMD128, and everything else falls back to plain loops. The broadcast
+// (scalar-op-array) cases are specialized so the hot paths never touch
+// a per-element lambda.
+enum class BinOp { ADD, SUB, MUL, DIV, POW };
+
+// dst[i] = a[i] op b[i]
+void binaryDouble(BinOp op, const double *a, const double *b, double *dst, size_t n);
+// dst[i] = a op b[i]
+void binaryDoubleScalarLeft(BinOp op, double a, const double *b, double *dst, size_t n);
+// dst[i] = a[i] op b
+void binaryDoubleScalarRight(BinOp op, const double *a, double b, double *dst, size_t n);
+
+// Elementwise comparisons producing 0/1 byte masks; the predicate is
+// hoisted out of the loop so the compiler emits packed compares.
+enum class CmpOp { EQ, NE, LT, GT, LE, GE };
+void compareDouble(CmpOp op, const double *a, const double *b, uint8_t *dst, size_t n);
+void compareDoubleScalarLeft(CmpOp op, double a, const double *b, uint8_t *dst, size_t n);
+void compareDoubleScalarRight(CmpOp op, const double *a, double b, uint8_t *dst, size_t n);
+
+// Word-at-a-time mask kernels over normalized 0/1 byte masks (the
+// engine's logical storage invariant): eight elements per uint64 op.
+void logicalAnd(const uint8_t *a, const uint8_t *b, uint8_t *dst, size_t n);
+void logicalOr(const uint8_t *a, const uint8_t *b, uint8_t *dst, size_t n);
+void logicalNot(const uint8_t *a, uint8_t *dst, size_t n);
+// Number of true entries (popcount over 0/1 bytes, 8 at a time).
+size_t logicalCount(const uint8_t *a, size_t n);
+
+// Reductions. reduceSum uses blocked pairwise accumulation for
+// accuracy and splits across the ThreadPool above a size threshold;
+// the strided variants serve row/page reductions over column-major
+// data. reduceMin/reduceMax also report the first extremum's index.
+double reduceSum(const double *a, size_t n);
+double reduceProd(const double *a, size_t n);
+double reduceSumStrided(const double *a, size_t n, size_t stride);
+double reduceProdStrided(const double *a, size_t n, size_t stride);
+void reduceMin(const double *a, size_t n, double &val, size_t &idx);
+void reduceMax(const double *a, size_t n, double &val, size_t &idx);
+double reduceMinStrided(const double *a, size_t n, size_t stride);
+double reduceMaxStrided(const double *a, size_t n, size_t stride);
+
+// Cache-blocked matrix multiply, column-major: c(M×N) = a(M×K) * b(K×N).
+// c must be zero-initialized. Large products are split across the global
+// ThreadPool by column blocks; small ones stay on the caller's thread.
+void matmulDouble(const double *a, const double *b, double *c, size_t M, size_t K, size_t N);
+void matmulComplex(const std::complex<double> *a,
+                   const std::complex<double> *b,
+                   std::complex<double> *c,
+                   size_t M,
+                   size_t K,
+                   size_t N);
+
+} // namespace kernels
+} // namespace mlab
@@ -1,6 +1,8 @@
 #pragma once
 
+#include <deque>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace mlab {
@@ -72,7 +74,10 @@ enum class TokenType {
 struct Token
 {
     TokenType type;
-    std::string value;
+    // Zero-copy slice of the Lexer's source (or of its side buffer for
+    // string literals containing escapes) — valid only while the Lexer
+    // that produced it is alive.
+    std::string_view value;
     int line = 0;
     int col = 0;
 };
@@ -81,6 +86,9 @@ class Lexer
 {
 public:
     explicit Lexer(const std::string &source);
+
+    // Token values reference the Lexer's internal storage; keep the
+    // Lexer alive for as long as the returned tokens are used.
     std::vector<Token> tokenize();
 
 private:
@@ -90,6 +98,9 @@ private:
     int col_ = 1;
     std::vector<Token> tokens_;
     std::vector<char> bracketStack_;
+    // Backing store for string literals that needed unescaping; deque so
+    // the views stay stable as it grows.
+    std::deque<std::string> ownedStrings_;
 
     char peek() const;
     char peek(int offset) const;
@@ -105,7 +116,7 @@ private:
 
     void skipSpacesAndComments();
     void skipBlockComment();
-    void addToken(TokenType type, const std::string &val, int line, int col);
+    void addToken(TokenType type, std::string_view val, int line, int col);
     bool isValueToken(TokenType t) const;
     bool isTransposeContext() const;
 
@@ -0,0 +1,33 @@
+// include/MLabOptimizer.hpp
+#pragma once
+
+#include "MLabAst.hpp"
+
+namespace mlab {
+
+// Post-parse optimization pass run by Engine::compile before slot
+// resolution: folds arithmetic and comparisons over numeric literals,
+// collapses constant-condition if-branches, and simplifies literal
+// unary minus/plus, so generated scripts full of constants stop paying
+// execBinaryOp dispatch per evaluation.
+//
+// Folding assumes the stdlib semantics of + - * / ^ (and their dotted
+// forms) on scalars; hosts that re-register those operators with
+// different behavior should disable the pass via
+// Engine::setAstOptimization(false).
+class ASTOptimizer
+{
+public:
+    static void run(ASTNode *root);
+
+private:
+    static void optimizeNode(ASTNode *node);
+    static void foldUnary(ASTNode *node);
+    static void foldBinary(ASTNode *node);
+    static void pruneIf(ASTNode *node);
+
+    // Extracts a numeric constant from NUMBER_LITERAL / BOOL_LITERAL.
+    static bool constValue(const ASTNode *node, double &out);
+};
+
+} // namespace mlab
@@ -3,6 +3,7 @@
 #include "MLabAst.hpp"
 #include "MLabLexer.hpp"
 #include <initializer_list>
+#include <string_view>
 #include <vector>
 
 namespace mlab {
@@ -39,7 +40,7 @@ private:
     bool isTerminator(std::initializer_list<TokenType> terminators) const;
 
     // — Безопасный парсинг числа —
-    static double parseDouble(const std::string &text, int line, int col);
+    static double parseDouble(std::string_view text, int line, int col);
 
     // — Statements —
     ASTNodePtr parseStatement();
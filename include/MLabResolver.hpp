@@ -0,0 +1,54 @@
+// include/MLabResolver.hpp
+#pragma once
+
+#include "MLabAst.hpp"
+
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace mlab {
+
+// Post-parse pass that assigns integer slot indices to variables so
+// identifier reads and writes become array indexing instead of hash
+// lookups (see Environment::slotRead/slotWrite).
+//
+// Two numbering domains exist: top-level statements use the engine's
+// persistent global slot registry (the same name maps to the same slot
+// across every script evaluated by that engine), while function bodies
+// number their parameters and locally assigned names per call frame.
+// FUNCTION_DEF and ANON_FUNC subtrees are skipped by the enclosing
+// domain and resolved on their own when the function is defined.
+class SlotResolver
+{
+public:
+    using GlobalSlotFn = std::function<int(const std::string &)>;
+
+    // Resolve a top-level program against the engine's global registry.
+    // builtinFor (optional) maps callee names to direct-dispatch builtin
+    // ids stamped onto CALL nodes.
+    static void resolveGlobal(ASTNode *root,
+                              const GlobalSlotFn &slotFor,
+                              const GlobalSlotFn *builtinFor = nullptr);
+
+    // Resolve a function body: parameters and every name assigned in
+    // the body (excluding global/persistent declarations) get frame
+    // slots. Returns the frame size.
+    static int resolveFunction(ASTNode *body,
+                               const std::vector<std::string> &params,
+                               const GlobalSlotFn *builtinFor = nullptr);
+
+    // Collects every identifier referenced in the subtree (including
+    // nested anonymous functions) for free-variable capture analysis.
+    static void collectIdentifiers(const ASTNode *node, std::vector<std::string> &names);
+
+private:
+    static void collectLocals(const ASTNode *node,
+                              std::vector<std::string> &locals,
+                              std::vector<std::string> &excluded);
+    static void apply(ASTNode *node,
+                      const GlobalSlotFn &slotFor,
+                      const GlobalSlotFn *builtinFor);
+};
+
+} // namespace mlab
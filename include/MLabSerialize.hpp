@@ -0,0 +1,27 @@
+// include/MLabSerialize.hpp
+#pragma once
+
+#include "MLabValue.hpp"
+
+#include <iosfwd>
+#include <string>
+
+namespace mlab {
+namespace serialize {
+
+// Binary workspace format (little-endian, column-major payloads):
+//   "MLABWS1\0" magic, u64 variable count, then per variable a length-
+//   prefixed name followed by the value. Numeric/char/logical payloads
+//   are padded to 8-byte alignment so a future memory-mapping loader can
+//   reference them in place; cells and structs nest recursively.
+void writeValue(std::ostream &os, const MValue &val);
+MValue readValue(std::istream &is, Allocator *alloc);
+
+void writeHeader(std::ostream &os, size_t varCount);
+size_t readHeader(std::istream &is);
+
+void writeName(std::ostream &os, const std::string &name);
+std::string readName(std::istream &is);
+
+} // namespace serialize
+} // namespace mlab
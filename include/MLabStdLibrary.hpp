@@ -17,6 +17,8 @@ private:
     static void registerIOFunctions(Engine &engine);
     static void registerTypeFunctions(Engine &engine);
     static void registerCellStructFunctions(Engine &engine);
+    static void registerFunctionalFunctions(Engine &engine);
+    static void registerIntegerFunctions(Engine &engine);
     static void registerStringFunctions(Engine &engine);
     static void registerComplexFunctions(Engine &engine);
 };
@@ -0,0 +1,51 @@
+// include/MLabThreadPool.hpp
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace mlab {
+
+// Small shared worker pool for data-parallel kernels (matmul, reductions,
+// arrayfun). Workers are started lazily on first use; parallelFor blocks
+// the caller until every chunk has run. On single-core targets (and under
+// Emscripten, where spawning threads needs explicit opt-in) the pool has
+// no workers and chunks run inline on the caller.
+class ThreadPool
+{
+public:
+    static ThreadPool &global();
+
+    explicit ThreadPool(size_t numThreads);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    size_t numThreads() const { return threads_.size(); }
+
+    // Splits [begin, end) into chunks of at least `grain` items and runs
+    // fn(chunkBegin, chunkEnd) across the workers plus the caller.
+    void parallelFor(size_t begin,
+                     size_t end,
+                     size_t grain,
+                     const std::function<void(size_t, size_t)> &fn);
+
+private:
+    std::vector<std::thread> threads_;
+    std::queue<std::function<void()>> tasks_;
+    std::mutex mutex_;
+    std::condition_variable taskReady_;
+    std::condition_variable taskDone_;
+    size_t pendingTasks_ = 0;
+    bool stopping_ = false;
+
+    void workerLoop();
+};
+
+} // namespace mlab
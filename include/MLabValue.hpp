@@ -7,9 +7,9 @@
 #include <cstddef>
 #include <cstdint>
 #include <initializer_list>
-#include <map>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace mlab {
@@ -25,6 +25,7 @@ enum class MType {
     CELL,
     STRUCT,
     FUNC_HANDLE,
+    STRING, // string array: pooled char buffer + offset table
     INT8,
     INT16,
     INT32,
@@ -37,6 +38,13 @@ enum class MType {
 
 const char *mtypeName(MType t);
 size_t elementSize(MType t);
+bool isIntegerType(MType t);
+
+// Process-wide interning of struct field names: repeated access to the
+// same field compares integer ids instead of hashing strings. Ids are
+// assigned once per distinct name and never recycled.
+uint32_t internFieldName(const std::string &name);
+const std::string &fieldNameById(uint32_t id);
 
 struct Dims
 {
@@ -70,7 +78,9 @@ struct Dims
 class DataBuffer
 {
 public:
-    DataBuffer(size_t bytes, Allocator *alloc);
+    // capacityBytes lets growth paths over-allocate; the buffer always
+    // reserves at least `bytes`. bytes() reports the logical size.
+    DataBuffer(size_t bytes, Allocator *alloc, size_t capacityBytes = 0);
     ~DataBuffer();
 
     DataBuffer(const DataBuffer &) = delete;
@@ -79,8 +89,14 @@ public:
     void *data() { return data_; }
     const void *data() const { return data_; }
     size_t bytes() const { return bytes_; }
+    size_t capacity() const { return capacity_; }
     Allocator *allocator() const { return allocator_; }
 
+    // Extends the logical size within the reserved capacity (the caller
+    // zero-fills the new region). Returns false when a reallocation is
+    // needed instead.
+    bool growWithin(size_t newBytes);
+
     void addRef();
     bool release();
     int refCount() const;
@@ -88,6 +104,7 @@ public:
 private:
     void *data_ = nullptr;
     size_t bytes_ = 0;
+    size_t capacity_ = 0;
     std::atomic<int> refCount_{1};
     Allocator *allocator_ = nullptr;
 };
@@ -118,7 +135,19 @@ public:
                            MType t = MType::DOUBLE,
                            Allocator *alloc = nullptr);
     static MValue fromString(const std::string &s, Allocator *alloc = nullptr);
+    // Lazy colon range: behaves as a 1xCount DOUBLE row vector but holds
+    // no buffer until raw data access or mutation materializes it.
+    static MValue range(double start, double step, double stop, size_t count,
+                        Allocator *alloc = nullptr);
+    // Non-owning slice view: shares src's buffer at an element offset
+    // with new dims. Reads are zero-copy; the first write (detach)
+    // materializes just the viewed region. Raw-buffer types only.
+    static MValue view(const MValue &src, size_t elemOffset, size_t rows, size_t cols);
+
     static MValue cell(size_t rows, size_t cols);
+    // String array: all characters live in one pooled buffer with an
+    // offset table, so a 100k-entry array is two allocations, not 100k.
+    static MValue stringArray(std::vector<std::string> items);
     static MValue structure();
     static MValue funcHandle(const std::string &name, Allocator *alloc = nullptr);
     static MValue empty();
@@ -141,11 +170,19 @@ public:
     bool isCell() const;
     bool isStruct() const;
     bool isFuncHandle() const;
+    bool isStringArray() const;
+    bool isRange() const;
+    bool isView() const;
 
     // Const raw access
     const void *rawData() const;
     size_t rawBytes() const;
 
+    // Owners of the numeric buffer (1 for inline scalars, 0 when there
+    // is no payload). Used to detect when arithmetic may reuse a
+    // uniquely-owned destination in place.
+    int bufferRefCount() const;
+
     // Const typed access — double
     const double *doubleData() const;
     const uint8_t *logicalData() const;
@@ -195,15 +232,37 @@ public:
     std::vector<MValue> &cellDataVec();
     const std::vector<MValue> &cellDataVec() const;
 
-    // Struct
+    // Struct — fields are stored flat in insertion order, keyed by
+    // interned ids; same-shaped structs share the id sequence so hot
+    // access is an integer scan rather than a string-keyed map probe.
     MValue &field(const std::string &name);
     const MValue &field(const std::string &name) const;
+    MValue &fieldById(uint32_t id);
+    const MValue *findFieldById(uint32_t id) const;
     bool hasField(const std::string &name) const;
-    std::map<std::string, MValue> &structFields();
-    const std::map<std::string, MValue> &structFields() const;
+    size_t fieldCount() const;
+    const std::string &fieldNameAt(size_t i) const;
+    MValue &fieldAt(size_t i);
+    const MValue &fieldAt(size_t i) const;
+    bool removeField(const std::string &name);
+
+    // String array
+    std::string_view stringAt(size_t i) const;
+    size_t stringBytes() const; // pooled character buffer size
+    std::string_view pooledChars() const;
+    const std::vector<size_t> &stringOffsets() const;
+    // Builds a string array directly from a pooled buffer + offsets
+    // (offsets.size() == count + 1), for single-pass transforms.
+    static MValue stringArrayFromPool(std::string chars, std::vector<size_t> offsets);
 
     // Func handle
     std::string funcHandleName() const;
+    // Direct-target binding filled in by the engine that created the
+    // handle; only honored by that engine (see handleOwner).
+    void bindHandleTarget(const void *owner, int builtinId, const void *userFunc);
+    const void *handleOwner() const { return handleOwner_; }
+    int handleBuiltinId() const { return handleBuiltinId_; }
+    const void *handleUserFunc() const { return handleUserFunc_; }
 
     // Debug
     std::string debugString() const;
@@ -213,11 +272,68 @@ private:
     Dims dims_;
     DataBuffer *buffer_ = nullptr;
     Allocator *allocator_ = nullptr;
-
-    std::vector<MValue> cellData_;
-    std::map<std::string, MValue> structData_;
+    size_t elemOffset_ = 0; // view offset into buffer_, in elements
+
+    // Small-value optimization: scalar DOUBLE/LOGICAL/COMPLEX payloads
+    // live inline instead of behind a heap-allocated DataBuffer. The
+    // inline value is uniquely owned, so detach() is a no-op for it.
+    alignas(Complex) unsigned char small_[sizeof(Complex)] = {};
+    bool inline_ = false;
+
+    // Lazy range state (type_ == DOUBLE, no buffer): element i is
+    // start + i*step with the final element clamped to stop, exactly as
+    // execColonExpr materialized it.
+    bool range_ = false;
+    double rangeStart_ = 0;
+    double rangeStep_ = 1;
+    double rangeStop_ = 0;
+
+    double rangeElem(size_t i) const;
+    void materializeRange() const;
+
+    // Cell and struct payloads share the same refcount+detach scheme as
+    // numeric buffers, so copying a container value is O(1) until one of
+    // the copies mutates it.
+    struct CellData
+    {
+        std::atomic<int> refCount{1};
+        std::vector<MValue> items;
+    };
+    struct StructData
+    {
+        std::atomic<int> refCount{1};
+        std::vector<uint32_t> ids;  // layout: interned ids in slot order
+        std::vector<MValue> vals;
+    };
+    struct StringData
+    {
+        std::atomic<int> refCount{1};
+        std::string chars;            // pooled characters, back to back
+        std::vector<size_t> offsets;  // count+1 entries into chars
+    };
+
+    CellData *cellData_ = nullptr;
+    StructData *structData_ = nullptr;
+    StringData *stringData_ = nullptr;
     std::string funcHandleName_;
 
+    // Function-handle fast dispatch (valid only for handleOwner_'s
+    // engine; foreign engines fall back to name resolution).
+    const void *handleOwner_ = nullptr;
+    int handleBuiltinId_ = -1;
+    const void *handleUserFunc_ = nullptr;
+
+    CellData &cellDataOrCreate();
+    StructData &structDataOrCreate();
+
+    void detachCell();
+    void detachStruct();
+    void releaseContainers();
+
+    bool hasData() const { return inline_ || buffer_ != nullptr; }
+    const void *payload() const;
+    void *payloadMut();
+
     void detach();
     void releaseBuffer();
 };
@@ -1,12 +1,163 @@
 // src/MLabAllocator.cpp
 #include "MLabAllocator.hpp"
 
+#include <algorithm>
+#include <new>
+
 namespace mlab {
 
+// ============================================================
+// Default allocator
+// ============================================================
+static void *defaultAllocFast(void *, size_t n)
+{
+    return ::operator new(n);
+}
+
+static void defaultDeallocFast(void *, void *p, size_t)
+{
+    ::operator delete(p);
+}
+
 Allocator Allocator::defaultAllocator()
 {
-    return {[](size_t n) -> void * { return ::operator new(n); },
-            [](void *p, size_t) { ::operator delete(p); }};
+    Allocator alloc{[](size_t n) -> void * { return ::operator new(n); },
+                    [](void *p, size_t) { ::operator delete(p); }};
+    alloc.allocateFast = &defaultAllocFast;
+    alloc.deallocateFast = &defaultDeallocFast;
+    return alloc;
+}
+
+// ============================================================
+// PoolAllocator
+// ============================================================
+constexpr size_t PoolAllocator::kClassSizes[5];
+
+PoolAllocator::~PoolAllocator()
+{
+    for (void *slab : slabs_)
+        ::operator delete(slab);
+}
+
+int PoolAllocator::classFor(size_t bytes)
+{
+    for (int i = 0; i < 5; ++i)
+        if (bytes <= kClassSizes[i])
+            return i;
+    return -1;
+}
+
+void *PoolAllocator::allocate(size_t bytes)
+{
+    int cls = classFor(bytes);
+    if (cls < 0)
+        return ::operator new(bytes);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!freeLists_[cls]) {
+        // Carve a fresh slab into chunks of this class size.
+        size_t chunk = kClassSizes[cls];
+        char *slab = static_cast<char *>(::operator new(kSlabBytes));
+        slabs_.push_back(slab);
+        for (size_t off = 0; off + chunk <= kSlabBytes; off += chunk) {
+            auto *node = reinterpret_cast<FreeNode *>(slab + off);
+            node->next = freeLists_[cls];
+            freeLists_[cls] = node;
+        }
+    }
+    FreeNode *node = freeLists_[cls];
+    freeLists_[cls] = node->next;
+    return node;
+}
+
+void PoolAllocator::deallocate(void *p, size_t bytes)
+{
+    int cls = classFor(bytes);
+    if (cls < 0) {
+        ::operator delete(p);
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto *node = static_cast<FreeNode *>(p);
+    node->next = freeLists_[cls];
+    freeLists_[cls] = node;
+}
+
+size_t PoolAllocator::slabCount() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return slabs_.size();
+}
+
+Allocator PoolAllocator::allocator()
+{
+    Allocator alloc;
+    alloc.ctx = this;
+    alloc.allocateFast = [](void *ctx, size_t n) {
+        return static_cast<PoolAllocator *>(ctx)->allocate(n);
+    };
+    alloc.deallocateFast = [](void *ctx, void *p, size_t n) {
+        static_cast<PoolAllocator *>(ctx)->deallocate(p, n);
+    };
+    return alloc;
+}
+
+// ============================================================
+// ArenaAllocator
+// ============================================================
+ArenaAllocator::ArenaAllocator(size_t blockBytes)
+    : blockBytes_(std::max(blockBytes, size_t(1024)))
+{
+    blocks_.push_back({static_cast<char *>(::operator new(blockBytes_)), blockBytes_});
+}
+
+ArenaAllocator::~ArenaAllocator()
+{
+    for (auto &block : blocks_)
+        ::operator delete(block.data);
+}
+
+void *ArenaAllocator::allocate(size_t bytes)
+{
+    size_t aligned = (bytes + 15) & ~size_t(15);
+    Block &last = blocks_.back();
+    if (offset_ + aligned > last.capacity) {
+        size_t cap = std::max(blockBytes_, aligned);
+        blocks_.push_back({static_cast<char *>(::operator new(cap)), cap});
+        offset_ = 0;
+    }
+    void *p = blocks_.back().data + offset_;
+    offset_ += aligned;
+    totalUsed_ += aligned;
+    return p;
+}
+
+void ArenaAllocator::reset()
+{
+    while (blocks_.size() > 1) {
+        ::operator delete(blocks_.back().data);
+        blocks_.pop_back();
+    }
+    offset_ = 0;
+    totalUsed_ = 0;
+}
+
+size_t ArenaAllocator::bytesAllocated() const
+{
+    return totalUsed_;
+}
+
+Allocator ArenaAllocator::allocator()
+{
+    Allocator alloc;
+    alloc.ctx = this;
+    alloc.allocateFast = [](void *ctx, size_t n) {
+        return static_cast<ArenaAllocator *>(ctx)->allocate(n);
+    };
+    alloc.deallocateFast = [](void *, void *, size_t) {
+        // Arena memory is reclaimed wholesale by reset().
+    };
+    return alloc;
 }
 
 } // namespace mlab
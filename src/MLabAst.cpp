@@ -3,6 +3,78 @@
 
 namespace mlab {
 
+const char *nodeTypeName(NodeType t)
+{
+    switch (t) {
+    case NodeType::NUMBER_LITERAL:
+        return "number_literal";
+    case NodeType::IMAG_LITERAL:
+        return "imag_literal";
+    case NodeType::STRING_LITERAL:
+        return "string_literal";
+    case NodeType::BOOL_LITERAL:
+        return "bool_literal";
+    case NodeType::IDENTIFIER:
+        return "identifier";
+    case NodeType::BINARY_OP:
+        return "binary_op";
+    case NodeType::UNARY_OP:
+        return "unary_op";
+    case NodeType::ASSIGN:
+        return "assign";
+    case NodeType::MULTI_ASSIGN:
+        return "multi_assign";
+    case NodeType::INDEX:
+        return "index";
+    case NodeType::CELL_INDEX:
+        return "cell_index";
+    case NodeType::FIELD_ACCESS:
+        return "field_access";
+    case NodeType::MATRIX_LITERAL:
+        return "matrix_literal";
+    case NodeType::CELL_LITERAL:
+        return "cell_literal";
+    case NodeType::CALL:
+        return "call";
+    case NodeType::COLON_EXPR:
+        return "colon_expr";
+    case NodeType::IF_STMT:
+        return "if_stmt";
+    case NodeType::FOR_STMT:
+        return "for_stmt";
+    case NodeType::WHILE_STMT:
+        return "while_stmt";
+    case NodeType::BREAK_STMT:
+        return "break_stmt";
+    case NodeType::CONTINUE_STMT:
+        return "continue_stmt";
+    case NodeType::RETURN_STMT:
+        return "return_stmt";
+    case NodeType::SWITCH_STMT:
+        return "switch_stmt";
+    case NodeType::FUNCTION_DEF:
+        return "function_def";
+    case NodeType::BLOCK:
+        return "block";
+    case NodeType::EXPR_STMT:
+        return "expr_stmt";
+    case NodeType::END_VAL:
+        return "end_val";
+    case NodeType::ANON_FUNC:
+        return "anon_func";
+    case NodeType::TRY_STMT:
+        return "try_stmt";
+    case NodeType::GLOBAL_STMT:
+        return "global_stmt";
+    case NodeType::PERSISTENT_STMT:
+        return "persistent_stmt";
+    case NodeType::DELETE_ASSIGN:
+        return "delete_assign";
+    default:
+        return "unknown";
+    }
+}
+
 // ============================================================
 // Фабрики узлов
 // ============================================================
@@ -32,6 +104,9 @@ ASTNodePtr cloneNode(const ASTNode *src)
     dst->numValue = src->numValue;
     dst->boolValue = src->boolValue;
     dst->suppressOutput = src->suppressOutput;
+    dst->slot = src->slot;
+    dst->fieldId = src->fieldId;
+    dst->builtinId = src->builtinId;
     dst->paramNames = src->paramNames;
     dst->returnNames = src->returnNames;
 
@@ -0,0 +1,434 @@
+// src/MLabBytecode.cpp
+#include "MLabBytecode.hpp"
+#include "MLabEngine.hpp"
+
+#include <stdexcept>
+
+namespace mlab {
+
+// ============================================================
+// Compiler — entry point
+// ============================================================
+bool BytecodeCompiler::compile(const ASTNode *root, const Engine &engine, BytecodeChunk &out)
+{
+    BytecodeCompiler compiler(engine, out);
+    try {
+        compiler.compileStatement(root);
+    } catch (Unsupported &) {
+        return false;
+    }
+    out.numLoopSlots = compiler.maxLoopDepth_;
+    return true;
+}
+
+// ============================================================
+// Compiler — emission helpers
+// ============================================================
+size_t BytecodeCompiler::emit(OpCode op, int a, int b, int c)
+{
+    chunk_.code.push_back({op, a, b, c});
+    return chunk_.code.size() - 1;
+}
+
+void BytecodeCompiler::patchTarget(size_t instrIdx, int target)
+{
+    chunk_.code[instrIdx].a = target;
+}
+
+int BytecodeCompiler::here() const
+{
+    return static_cast<int>(chunk_.code.size());
+}
+
+int BytecodeCompiler::addConstant(MValue val)
+{
+    chunk_.constants.push_back(std::move(val));
+    return static_cast<int>(chunk_.constants.size() - 1);
+}
+
+int BytecodeCompiler::addName(const std::string &name)
+{
+    for (size_t i = 0; i < chunk_.names.size(); ++i)
+        if (chunk_.names[i] == name)
+            return static_cast<int>(i);
+    chunk_.names.push_back(name);
+    return static_cast<int>(chunk_.names.size() - 1);
+}
+
+int BytecodeCompiler::addBinaryOp(const std::string &op)
+{
+    const BinaryOpFunc *func = engine_.findBinaryOp(op);
+    if (!func)
+        throw Unsupported{};
+    chunk_.binaryOps.push_back(func);
+    return static_cast<int>(chunk_.binaryOps.size() - 1);
+}
+
+int BytecodeCompiler::addUnaryOp(const std::string &op)
+{
+    const UnaryOpFunc *func = engine_.findUnaryOp(op);
+    if (!func)
+        throw Unsupported{};
+    chunk_.unaryOps.push_back(func);
+    return static_cast<int>(chunk_.unaryOps.size() - 1);
+}
+
+// ============================================================
+// Compiler — statements
+// ============================================================
+void BytecodeCompiler::compileStatement(const ASTNode *node)
+{
+    if (!node)
+        return;
+
+    switch (node->type) {
+    case NodeType::BLOCK:
+        compileBlock(node);
+        return;
+    case NodeType::EXPR_STMT:
+        compileExpression(node->children[0].get());
+        if (!node->suppressOutput)
+            emit(OpCode::SET_ANS_DISPLAY);
+        emit(OpCode::POP_TO_LAST);
+        return;
+    case NodeType::ASSIGN: {
+        const ASTNode *lhs = node->children[0].get();
+        if (lhs->type != NodeType::IDENTIFIER)
+            throw Unsupported{}; // indexed/field/cell assignment → tree walker
+        compileExpression(node->children[1].get());
+        emit(node->suppressOutput ? OpCode::STORE_VAR : OpCode::STORE_VAR_DISPLAY,
+             addName(lhs->strValue),
+             lhs->slot);
+        return;
+    }
+    case NodeType::IF_STMT:
+        compileIf(node);
+        return;
+    case NodeType::WHILE_STMT:
+        compileWhile(node);
+        return;
+    case NodeType::FOR_STMT:
+        compileFor(node);
+        return;
+    case NodeType::BREAK_STMT: {
+        if (loopStack_.empty())
+            throw Unsupported{};
+        loopStack_.back().breakJumps.push_back(emit(OpCode::JUMP));
+        return;
+    }
+    case NodeType::CONTINUE_STMT: {
+        if (loopStack_.empty())
+            throw Unsupported{};
+        loopStack_.back().continueJumps.push_back(emit(OpCode::JUMP));
+        return;
+    }
+    default:
+        throw Unsupported{};
+    }
+}
+
+void BytecodeCompiler::compileBlock(const ASTNode *node)
+{
+    for (auto &child : node->children)
+        compileStatement(child.get());
+}
+
+void BytecodeCompiler::compileIf(const ASTNode *node)
+{
+    std::vector<size_t> endJumps;
+    for (auto &[cond, body] : node->branches) {
+        compileExpression(cond.get());
+        size_t skip = emit(OpCode::JUMP_IF_FALSE);
+        compileStatement(body.get());
+        endJumps.push_back(emit(OpCode::JUMP));
+        patchTarget(skip, here());
+    }
+    if (node->elseBranch)
+        compileStatement(node->elseBranch.get());
+    for (auto idx : endJumps)
+        patchTarget(idx, here());
+}
+
+void BytecodeCompiler::compileWhile(const ASTNode *node)
+{
+    int loopStart = here();
+    compileExpression(node->children[0].get());
+    size_t exitJump = emit(OpCode::JUMP_IF_FALSE);
+
+    loopStack_.push_back({});
+    compileStatement(node->children[1].get());
+    emit(OpCode::JUMP, loopStart);
+
+    int loopEnd = here();
+    patchTarget(exitJump, loopEnd);
+    for (auto idx : loopStack_.back().breakJumps)
+        patchTarget(idx, loopEnd);
+    for (auto idx : loopStack_.back().continueJumps)
+        patchTarget(idx, loopStart);
+    loopStack_.pop_back();
+}
+
+void BytecodeCompiler::compileFor(const ASTNode *node)
+{
+    const ASTNode *range = node->children[0].get();
+    // Only literal colon ranges are compiled; matrix/cell iteration
+    // falls back to the tree walker.
+    if (range->type != NodeType::COLON_EXPR
+        || (range->children.size() != 2 && range->children.size() != 3))
+        throw Unsupported{};
+
+    int slot = static_cast<int>(loopStack_.size());
+    if (slot + 1 > maxLoopDepth_)
+        maxLoopDepth_ = slot + 1;
+    int nameIdx = addName(node->strValue);
+
+    compileExpression(range->children[0].get()); // start
+    if (range->children.size() == 3) {
+        compileExpression(range->children[1].get()); // step
+        compileExpression(range->children[2].get()); // stop
+    } else {
+        emit(OpCode::PUSH_CONST, addConstant(MValue::scalar(1.0)));
+        compileExpression(range->children[1].get());
+    }
+    size_t init = emit(OpCode::FOR_RANGE_INIT, slot, nameIdx);
+    chunk_.code[init].d = node->slot;
+
+    int bodyStart = here();
+    LoopContext loopCtx;
+    loopCtx.slot = slot;
+    loopStack_.push_back(std::move(loopCtx));
+    compileStatement(node->children[1].get());
+
+    int nextInstr = here();
+    chunk_.code.push_back({OpCode::FOR_RANGE_NEXT, slot, nameIdx, bodyStart, node->slot});
+
+    int loopEnd = here();
+    chunk_.code[init].c = loopEnd;
+    for (auto idx : loopStack_.back().breakJumps)
+        patchTarget(idx, loopEnd);
+    for (auto idx : loopStack_.back().continueJumps)
+        patchTarget(idx, nextInstr);
+    loopStack_.pop_back();
+}
+
+// ============================================================
+// Compiler — expressions
+// ============================================================
+void BytecodeCompiler::compileExpression(const ASTNode *node)
+{
+    switch (node->type) {
+    case NodeType::NUMBER_LITERAL:
+        emit(OpCode::PUSH_CONST, addConstant(MValue::scalar(node->numValue)));
+        return;
+    case NodeType::STRING_LITERAL:
+        emit(OpCode::PUSH_CONST, addConstant(MValue::fromString(node->strValue)));
+        return;
+    case NodeType::BOOL_LITERAL:
+        emit(OpCode::PUSH_CONST, addConstant(MValue::logicalScalar(node->boolValue)));
+        return;
+    case NodeType::IMAG_LITERAL:
+        emit(OpCode::PUSH_CONST, addConstant(MValue::complexScalar(0.0, node->numValue)));
+        return;
+    case NodeType::IDENTIFIER:
+        emit(OpCode::LOAD_VAR, addName(node->strValue), node->slot);
+        return;
+    case NodeType::BINARY_OP: {
+        if (node->strValue == "&&" || node->strValue == "||") {
+            compileShortCircuit(node, node->strValue == "&&");
+            return;
+        }
+        compileExpression(node->children[0].get());
+        compileExpression(node->children[1].get());
+        emit(OpCode::BINARY_OP, addBinaryOp(node->strValue));
+        return;
+    }
+    case NodeType::UNARY_OP:
+        compileExpression(node->children[0].get());
+        emit(OpCode::UNARY_OP, addUnaryOp(node->strValue));
+        return;
+    default:
+        throw Unsupported{};
+    }
+}
+
+void BytecodeCompiler::compileShortCircuit(const ASTNode *node, bool isAnd)
+{
+    compileExpression(node->children[0].get());
+    size_t branch = emit(OpCode::JUMP_IF_FALSE);
+    if (isAnd) {
+        // lhs true → result is logical(rhs)
+        compileExpression(node->children[1].get());
+        emit(OpCode::TO_LOGICAL);
+        size_t end = emit(OpCode::JUMP);
+        patchTarget(branch, here());
+        emit(OpCode::PUSH_FALSE);
+        patchTarget(end, here());
+    } else {
+        // lhs true → result is true
+        emit(OpCode::PUSH_TRUE);
+        size_t end = emit(OpCode::JUMP);
+        patchTarget(branch, here());
+        compileExpression(node->children[1].get());
+        emit(OpCode::TO_LOGICAL);
+        patchTarget(end, here());
+    }
+}
+
+// ============================================================
+// VM — interpreter loop
+// ============================================================
+MValue Engine::execBytecode(const BytecodeChunk &chunk, std::shared_ptr<Environment> env)
+{
+    struct LoopFrame
+    {
+        double start = 0;
+        double step = 1;
+        double stop = 0;
+        size_t count = 0;
+        size_t index = 0;
+
+        // Matches execColonExpr: values are start + i*step, with the
+        // final element clamped to stop when the step overshoots.
+        double valueAt(size_t i) const
+        {
+            double v = start + static_cast<double>(i) * step;
+            if (i + 1 == count && count >= 2) {
+                if (step > 0 && v > stop)
+                    return stop;
+                if (step < 0 && v < stop)
+                    return stop;
+            }
+            return v;
+        }
+    };
+
+    std::vector<MValue> stack;
+    stack.reserve(16);
+    std::vector<LoopFrame> loops(static_cast<size_t>(chunk.numLoopSlots));
+    MValue last = MValue::empty();
+
+    size_t ip = 0;
+    const size_t codeSize = chunk.code.size();
+    while (ip < codeSize) {
+        const Instr &ins = chunk.code[ip];
+        switch (ins.op) {
+        case OpCode::PUSH_CONST:
+            stack.push_back(chunk.constants[ins.a]);
+            break;
+        case OpCode::LOAD_VAR: {
+            if (ins.b >= 0) {
+                if (MValue *v = env->slotRead(ins.b)) {
+                    stack.push_back(*v);
+                    break;
+                }
+                env->slotBindLocal(ins.b, chunk.names[ins.a]);
+                if (MValue *v = env->slotRead(ins.b)) {
+                    stack.push_back(*v);
+                    break;
+                }
+            }
+            stack.push_back(loadIdentifier(chunk.names[ins.a], env));
+            break;
+        }
+        case OpCode::STORE_VAR:
+            if (ins.b >= 0)
+                env->slotWrite(ins.b, chunk.names[ins.a], stack.back());
+            else
+                env->set(chunk.names[ins.a], stack.back());
+            last = std::move(stack.back());
+            stack.pop_back();
+            break;
+        case OpCode::STORE_VAR_DISPLAY:
+            env->set(chunk.names[ins.a], stack.back());
+            displayValue(chunk.names[ins.a], stack.back());
+            last = std::move(stack.back());
+            stack.pop_back();
+            break;
+        case OpCode::SET_ANS_DISPLAY:
+            if (!stack.back().isEmpty()) {
+                env->set("ans", stack.back());
+                displayValue("ans", stack.back());
+            }
+            break;
+        case OpCode::POP_TO_LAST:
+            last = std::move(stack.back());
+            stack.pop_back();
+            break;
+        case OpCode::POP:
+            stack.pop_back();
+            break;
+        case OpCode::BINARY_OP: {
+            MValue rhs = std::move(stack.back());
+            stack.pop_back();
+            MValue result = (*chunk.binaryOps[ins.a])(stack.back(), rhs);
+            stack.back() = std::move(result);
+            break;
+        }
+        case OpCode::UNARY_OP:
+            stack.back() = (*chunk.unaryOps[ins.a])(stack.back());
+            break;
+        case OpCode::JUMP:
+            if (static_cast<size_t>(ins.a) < ip)
+                tick(); // loop back-edge
+            ip = static_cast<size_t>(ins.a);
+            continue;
+        case OpCode::JUMP_IF_FALSE: {
+            bool cond = stack.back().toBool();
+            stack.pop_back();
+            if (!cond) {
+                ip = static_cast<size_t>(ins.a);
+                continue;
+            }
+            break;
+        }
+        case OpCode::PUSH_TRUE:
+            stack.push_back(MValue::logicalScalar(true, &allocator_));
+            break;
+        case OpCode::PUSH_FALSE:
+            stack.push_back(MValue::logicalScalar(false, &allocator_));
+            break;
+        case OpCode::TO_LOGICAL: {
+            bool b = stack.back().toBool();
+            stack.back() = MValue::logicalScalar(b, &allocator_);
+            break;
+        }
+        case OpCode::FOR_RANGE_INIT: {
+            double stop = stack.back().toScalar();
+            stack.pop_back();
+            double step = stack.back().toScalar();
+            stack.pop_back();
+            double start = stack.back().toScalar();
+            stack.pop_back();
+            size_t count = static_cast<size_t>(colonCount(start, step, stop));
+            if (count == 0) {
+                ip = static_cast<size_t>(ins.c);
+                continue;
+            }
+            loops[ins.a] = {start, step, stop, count, 0};
+            if (ins.d >= 0)
+                env->slotWrite(ins.d, chunk.names[ins.b], MValue::scalar(start, &allocator_));
+            else
+                env->set(chunk.names[ins.b], MValue::scalar(start, &allocator_));
+            break;
+        }
+        case OpCode::FOR_RANGE_NEXT: {
+            LoopFrame &frame = loops[ins.a];
+            tick();
+            if (++frame.index < frame.count) {
+                MValue next = MValue::scalar(frame.valueAt(frame.index), &allocator_);
+                if (ins.d >= 0)
+                    env->slotWrite(ins.d, chunk.names[ins.b], std::move(next));
+                else
+                    env->set(chunk.names[ins.b], std::move(next));
+                ip = static_cast<size_t>(ins.c);
+                continue;
+            }
+            break;
+        }
+        }
+        ++ip;
+    }
+    return last;
+}
+
+} // namespace mlab
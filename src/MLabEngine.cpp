@@ -1,10 +1,18 @@
 // src/MLabEngine.cpp
 #include "MLabEngine.hpp"
+#include "MLabBytecode.hpp"
+#include "MLabKernels.hpp"
 #include "MLabLexer.hpp"
+#include "MLabOptimizer.hpp"
 #include "MLabParser.hpp"
+#include "MLabEnginePool.hpp"
+#include "MLabResolver.hpp"
+#include "MLabSerialize.hpp"
 #include <algorithm>
+#include <chrono>
 #include <cmath>
 #include <cstring>
+#include <fstream>
 #include <iostream>
 #include <limits>
 #include <sstream>
@@ -12,6 +20,8 @@
 
 namespace mlab {
 
+thread_local std::vector<Engine::IndexContext> Engine::indexContextStack_;
+
 // ============================================================
 // Construction & registration
 // ============================================================
@@ -19,7 +29,26 @@ Engine::Engine()
 {
     allocator_ = Allocator::defaultAllocator();
     globalEnv_ = std::make_shared<Environment>(nullptr, &globalStore_);
+    seedConstants();
+}
+
+Engine::Engine(std::shared_ptr<EngineContext> context)
+    : Engine()
+{
+    context_ = std::move(context);
+    const Engine &proto = context_->prototype();
+    // Shallow-share the immutable parts: std::function copies for the
+    // operator/builtin tables, shared_ptr-shared ASTs for user functions.
+    binaryOps_ = proto.binaryOps_;
+    unaryOps_ = proto.unaryOps_;
+    externalFuncs_ = proto.externalFuncs_;
+    userFuncs_ = proto.userFuncs_;
+    fastFuncs_ = proto.fastFuncs_;
+    fastFuncIds_ = proto.fastFuncIds_;
+}
 
+void Engine::seedConstants()
+{
     // Standard MATLAB constants
     globalEnv_->set("pi", MValue::scalar(3.14159265358979323846, &allocator_));
     globalEnv_->set("eps", MValue::scalar(2.2204460492503131e-16, &allocator_));
@@ -29,8 +58,14 @@ Engine::Engine()
     globalEnv_->set("NaN", MValue::scalar(std::numeric_limits<double>::quiet_NaN(), &allocator_));
     globalEnv_->set("true", MValue::logicalScalar(true, &allocator_));
     globalEnv_->set("false", MValue::logicalScalar(false, &allocator_));
-    globalEnv_->set("i", MValue::complexScalar(0.0, 1.0, &allocator_)); // ← заменить
-    globalEnv_->set("j", MValue::complexScalar(0.0, 1.0, &allocator_)); // ← заменить
+    globalEnv_->set("i", MValue::complexScalar(0.0, 1.0, &allocator_));
+    globalEnv_->set("j", MValue::complexScalar(0.0, 1.0, &allocator_));
+}
+
+void Engine::clearWorkspace()
+{
+    globalEnv_->clearAll();
+    seedConstants();
 }
 
 void Engine::setAllocator(Allocator alloc)
@@ -57,6 +92,157 @@ void Engine::registerFunction(const std::string &name, ExternalFunc func)
     externalFuncs_[name] = std::move(func);
 }
 
+void Engine::registerFastFunction(const std::string &name, FastFunc func)
+{
+    auto it = fastFuncIds_.find(name);
+    if (it != fastFuncIds_.end()) {
+        fastFuncs_[it->second] = std::move(func);
+        return;
+    }
+    fastFuncIds_[name] = static_cast<int>(fastFuncs_.size());
+    fastFuncs_.push_back(std::move(func));
+}
+
+int Engine::fastFunctionId(const std::string &name) const
+{
+    auto it = fastFuncIds_.find(name);
+    return (it != fastFuncIds_.end()) ? it->second : -1;
+}
+
+const BinaryOpFunc *Engine::findBinaryOp(const std::string &op) const
+{
+    auto it = binaryOps_.find(op);
+    return (it != binaryOps_.end()) ? &it->second : nullptr;
+}
+
+const UnaryOpFunc *Engine::findUnaryOp(const std::string &op) const
+{
+    auto it = unaryOps_.find(op);
+    return (it != unaryOps_.end()) ? &it->second : nullptr;
+}
+
+void Engine::setExecutionMode(ExecutionMode mode)
+{
+    executionMode_ = mode;
+}
+
+ExecutionMode Engine::executionMode() const
+{
+    return executionMode_;
+}
+
+void Engine::setAstOptimization(bool enabled)
+{
+    astOptimization_ = enabled;
+}
+
+void Engine::setInPlaceArithmetic(bool enabled)
+{
+    inPlaceArithmetic_ = enabled;
+}
+
+// ============================================================
+// Profiling
+// ============================================================
+void Engine::setProfiling(bool enabled)
+{
+    if (enabled == profiling_)
+        return;
+    profiling_ = enabled;
+    if (enabled) {
+        // Wrap the allocator so traffic is counted; the wrapper delegates
+        // to the previous strategy, which keeps alloc/free pairing valid
+        // across enable/disable.
+        unprofiledAllocator_ = allocator_;
+        Allocator prev = unprofiledAllocator_;
+        allocator_.allocateFast = nullptr;
+        allocator_.deallocateFast = nullptr;
+        allocator_.ctx = nullptr;
+        allocator_.allocate = [this, prev](size_t n) -> void * {
+            profileAllocCount_.fetch_add(1, std::memory_order_relaxed);
+            profileAllocBytes_.fetch_add(n, std::memory_order_relaxed);
+            if (prev.allocateFast)
+                return prev.allocateFast(prev.ctx, n);
+            if (prev.allocate)
+                return prev.allocate(n);
+            return ::operator new(n);
+        };
+        allocator_.deallocate = [prev](void *p, size_t n) {
+            if (prev.deallocateFast)
+                prev.deallocateFast(prev.ctx, p, n);
+            else if (prev.deallocate)
+                prev.deallocate(p, n);
+            else
+                ::operator delete(p);
+        };
+    } else {
+        allocator_ = unprofiledAllocator_;
+    }
+}
+
+void Engine::resetProfile()
+{
+    for (auto &counter : nodeProfile_) {
+        counter.count.store(0, std::memory_order_relaxed);
+        counter.ns.store(0, std::memory_order_relaxed);
+    }
+    {
+        std::lock_guard<std::mutex> lock(profileMutex_);
+        builtinProfile_.clear();
+    }
+    profileAllocCount_.store(0, std::memory_order_relaxed);
+    profileAllocBytes_.store(0, std::memory_order_relaxed);
+}
+
+void Engine::recordBuiltinProfile(const std::string &name, uint64_t ns)
+{
+    ProfileCounter *counter;
+    {
+        std::lock_guard<std::mutex> lock(profileMutex_);
+        counter = &builtinProfile_[name];
+    }
+    counter->count.fetch_add(1, std::memory_order_relaxed);
+    counter->ns.fetch_add(ns, std::memory_order_relaxed);
+}
+
+MValue Engine::profileReport()
+{
+    auto report = MValue::structure();
+
+    auto nodes = MValue::structure();
+    for (size_t i = 0; i < static_cast<size_t>(NodeType::NODE_TYPE_COUNT); ++i) {
+        uint64_t count = nodeProfile_[i].count.load(std::memory_order_relaxed);
+        if (count == 0)
+            continue;
+        auto entry = MValue::matrix(1, 2, MType::DOUBLE, &allocator_);
+        entry.doubleDataMut()[0] = static_cast<double>(count);
+        entry.doubleDataMut()[1] = static_cast<double>(
+                                       nodeProfile_[i].ns.load(std::memory_order_relaxed))
+                                   / 1e6; // ms
+        nodes.field(nodeTypeName(static_cast<NodeType>(i))) = entry;
+    }
+    report.field("nodes") = nodes;
+
+    auto builtins = MValue::structure();
+    std::lock_guard<std::mutex> lock(profileMutex_);
+    for (auto &[name, counter] : builtinProfile_) {
+        auto entry = MValue::matrix(1, 2, MType::DOUBLE, &allocator_);
+        entry.doubleDataMut()[0] = static_cast<double>(
+            counter.count.load(std::memory_order_relaxed));
+        entry.doubleDataMut()[1] = static_cast<double>(
+                                       counter.ns.load(std::memory_order_relaxed))
+                                   / 1e6;
+        builtins.field(name) = entry;
+    }
+    report.field("builtins") = builtins;
+
+    report.field("allocCount") = MValue::scalar(
+        static_cast<double>(profileAllocCount_.load(std::memory_order_relaxed)), &allocator_);
+    report.field("allocBytes") = MValue::scalar(
+        static_cast<double>(profileAllocBytes_.load(std::memory_order_relaxed)), &allocator_);
+    return report;
+}
+
 void Engine::setVariable(const std::string &name, MValue val)
 {
     globalEnv_->set(name, std::move(val));
@@ -76,9 +262,29 @@ void Engine::setMaxRecursionDepth(int d)
     maxRecursionDepth_ = d;
 }
 
+void Engine::setDisplayLimit(size_t maxElements)
+{
+    displayLimit_ = maxElements > 0 ? maxElements : 1;
+}
+
+const UserFunction *Engine::findUserFunction(const std::string &name) const
+{
+    std::shared_lock<std::shared_mutex> lock(userFuncsMutex_);
+    auto it = userFuncs_.find(name);
+    return it != userFuncs_.end() ? &it->second : nullptr;
+}
+
+const UserFunction *Engine::storeUserFunction(const std::string &name, UserFunction &&func)
+{
+    std::unique_lock<std::shared_mutex> lock(userFuncsMutex_);
+    auto &slot = userFuncs_[name];
+    slot = std::move(func);
+    return &slot;
+}
+
 bool Engine::isKnownFunction(const std::string &name) const
 {
-    return externalFuncs_.count(name) || userFuncs_.count(name);
+    return externalFuncs_.count(name) || findUserFunction(name) || fastFuncIds_.count(name);
 }
 
 // ============================================================
@@ -92,45 +298,92 @@ void Engine::output(const std::string &s)
         std::cout << s;
 }
 
+// Fast %g-equivalent double formatting straight into the buffer —
+// no ostream machinery per element.
+static void appendDouble(std::string &out, double v)
+{
+    char buf[32];
+    int n = std::snprintf(buf, sizeof(buf), "%g", v);
+    if (n > 0)
+        out.append(buf, static_cast<size_t>(n));
+}
+
 void Engine::displayValue(const std::string &name, const MValue &val)
 {
-    std::ostringstream os;
-    if (!name.empty() && name != "ans")
-        os << name << " =\n";
+    // One arena-style buffer, one OutputFunc call per displayed value:
+    // in the WASM REPL every chunk crosses the JS boundary.
+    std::string &out = displayBuffer_;
+    out.clear();
+    if (!name.empty() && name != "ans") {
+        out += name;
+        out += " =\n";
+    }
 
     switch (val.type()) {
     case MType::DOUBLE: {
         if (val.isScalar()) {
-            os << "    " << val.toScalar() << "\n";
+            out += "    ";
+            appendDouble(out, val.toScalar());
+            out += "\n";
         } else {
             auto d = val.dims();
-            for (size_t p = 0; p < d.pages(); ++p) {
-                if (d.is3D())
-                    os << "(:,:," << p + 1 << ") =\n";
+            size_t cols = d.cols() > 0 ? d.cols() : 1;
+            size_t maxRows = std::max<size_t>(1, displayLimit_ / cols);
+            out.reserve(out.size() + std::min(d.numel(), displayLimit_) * 12);
+            bool truncated = false;
+            for (size_t p = 0; p < d.pages() && !truncated; ++p) {
+                if (d.is3D()) {
+                    out += "(:,:,";
+                    appendDouble(out, static_cast<double>(p + 1));
+                    out += ") =\n";
+                }
                 for (size_t r = 0; r < d.rows(); ++r) {
-                    os << "   ";
-                    for (size_t c = 0; c < d.cols(); ++c)
-                        os << " " << val(r, c, p);
-                    os << "\n";
+                    if (p * d.rows() + r >= maxRows) {
+                        truncated = true;
+                        break;
+                    }
+                    out += "   ";
+                    for (size_t c = 0; c < d.cols(); ++c) {
+                        out += ' ';
+                        appendDouble(out, val(r, c, p));
+                    }
+                    out += "\n";
                 }
             }
+            if (truncated) {
+                size_t shown = maxRows;
+                out += "    ... (";
+                appendDouble(out, static_cast<double>(d.rows() * d.pages() - shown));
+                out += " more rows)\n";
+            }
         }
         break;
     }
     case MType::CHAR:
-        os << "    '" << val.toString() << "'\n";
+        out += "    '";
+        out += val.toString();
+        out += "'\n";
         break;
     case MType::LOGICAL: {
         if (val.isScalar()) {
-            os << "    " << (val.toBool() ? "true" : "false") << "\n";
+            out += val.toBool() ? "    true\n" : "    false\n";
         } else {
             auto d = val.dims();
             const uint8_t *ld = val.logicalData();
-            for (size_t r = 0; r < d.rows(); ++r) {
-                os << "   ";
-                for (size_t c = 0; c < d.cols(); ++c)
-                    os << " " << (ld[d.sub2ind(r, c)] ? "1" : "0");
-                os << "\n";
+            size_t cols = d.cols() > 0 ? d.cols() : 1;
+            size_t maxRows = std::max<size_t>(1, displayLimit_ / cols);
+            for (size_t r = 0; r < d.rows() && r < maxRows; ++r) {
+                out += "   ";
+                for (size_t c = 0; c < d.cols(); ++c) {
+                    out += ' ';
+                    out += ld[d.sub2ind(r, c)] ? '1' : '0';
+                }
+                out += "\n";
+            }
+            if (d.rows() > maxRows) {
+                out += "    ... (";
+                appendDouble(out, static_cast<double>(d.rows() - maxRows));
+                out += " more rows)\n";
             }
         }
         break;
@@ -138,72 +391,262 @@ void Engine::displayValue(const std::string &name, const MValue &val)
     case MType::COMPLEX: {
         if (val.isScalar()) {
             auto c = val.toComplex();
-            os << "   ";
-            if (c.real() != 0.0 || c.imag() == 0.0)
-                os << " " << c.real();
+            out += "   ";
+            if (c.real() != 0.0 || c.imag() == 0.0) {
+                out += ' ';
+                appendDouble(out, c.real());
+            }
             if (c.imag() != 0.0) {
                 if (c.real() != 0.0 && c.imag() > 0)
-                    os << " +";
+                    out += " +";
                 else if (c.real() != 0.0)
-                    os << " ";
-                os << " " << c.imag() << "i";
+                    out += " ";
+                out += ' ';
+                appendDouble(out, c.imag());
+                out += 'i';
             }
-            os << "\n";
+            out += "\n";
         } else {
             auto d = val.dims();
-            for (size_t r = 0; r < d.rows(); ++r) {
-                os << "   ";
+            size_t cols = d.cols() > 0 ? d.cols() : 1;
+            size_t maxRows = std::max<size_t>(1, displayLimit_ / cols);
+            for (size_t r = 0; r < d.rows() && r < maxRows; ++r) {
+                out += "   ";
                 for (size_t cc = 0; cc < d.cols(); ++cc) {
                     auto v = val.complexElem(r, cc);
-                    os << " " << v.real();
+                    out += ' ';
+                    appendDouble(out, v.real());
                     if (v.imag() >= 0)
-                        os << "+";
-                    os << v.imag() << "i";
+                        out += '+';
+                    appendDouble(out, v.imag());
+                    out += 'i';
                 }
-                os << "\n";
+                out += "\n";
+            }
+            if (d.rows() > maxRows) {
+                out += "    ... (";
+                appendDouble(out, static_cast<double>(d.rows() - maxRows));
+                out += " more rows)\n";
             }
         }
         break;
     }
     case MType::STRUCT:
-        os << "  struct with fields:\n";
-        for (auto &[k, v] : val.structFields())
-            os << "    " << k << ": " << v.debugString() << "\n";
+        out += "  struct with fields:\n";
+        for (size_t i = 0; i < val.fieldCount(); ++i) {
+            out += "    ";
+            out += val.fieldNameAt(i);
+            out += ": ";
+            out += val.fieldAt(i).debugString();
+            out += "\n";
+        }
         break;
     case MType::FUNC_HANDLE:
-        os << "    @" << val.funcHandleName() << "\n";
+        out += "    @";
+        out += val.funcHandleName();
+        out += "\n";
         break;
     case MType::CELL: {
         auto d = val.dims();
-        os << "  {" << d.rows() << "x" << d.cols() << " cell}\n";
-        for (size_t i = 0; i < val.numel() && i < 20; ++i)
-            os << "    {" << i + 1 << "}: " << val.cellAt(i).debugString() << "\n";
-        if (val.numel() > 20)
-            os << "    ... (" << val.numel() - 20 << " more)\n";
+        out += "  {";
+        appendDouble(out, static_cast<double>(d.rows()));
+        out += 'x';
+        appendDouble(out, static_cast<double>(d.cols()));
+        out += " cell}\n";
+        for (size_t i = 0; i < val.numel() && i < 20; ++i) {
+            out += "    {";
+            appendDouble(out, static_cast<double>(i + 1));
+            out += "}: ";
+            out += val.cellAt(i).debugString();
+            out += "\n";
+        }
+        if (val.numel() > 20) {
+            out += "    ... (";
+            appendDouble(out, static_cast<double>(val.numel() - 20));
+            out += " more)\n";
+        }
+        break;
+    }
+    case MType::STRING: {
+        out += "  [";
+        for (size_t i = 0; i < val.numel() && i < 20; ++i) {
+            if (i)
+                out += ", ";
+            out += '"';
+            auto sv = val.stringAt(i);
+            out.append(sv.data(), sv.size());
+            out += '"';
+        }
+        if (val.numel() > 20) {
+            out += ", ... (";
+            appendDouble(out, static_cast<double>(val.numel() - 20));
+            out += " more)";
+        }
+        out += "]\n";
         break;
     }
     case MType::EMPTY:
-        os << "    []\n";
+        out += "    []\n";
         break;
     default:
-        os << "    " << val.debugString() << "\n";
+        out += "    ";
+        out += val.debugString();
+        out += "\n";
         break;
     }
-    output(os.str());
+    output(out);
 }
 
 // ============================================================
-// eval
+// compile / run / eval
 // ============================================================
-MValue Engine::eval(const std::string &code)
+int Engine::globalSlotFor(const std::string &name)
+{
+    auto it = globalSlots_.find(name);
+    if (it != globalSlots_.end())
+        return it->second;
+    int slot = static_cast<int>(globalSlots_.size());
+    globalSlots_[name] = slot;
+    return slot;
+}
+
+Script Engine::compile(const std::string &code)
 {
     Lexer lexer(code);
     auto tokens = lexer.tokenize();
     Parser parser(tokens);
     auto ast = parser.parse();
+    if (astOptimization_)
+        ASTOptimizer::run(ast.get());
+    SlotResolver::GlobalSlotFn builtinFor = [this](const std::string &name) {
+        return fastFunctionId(name);
+    };
+    SlotResolver::resolveGlobal(
+        ast.get(),
+        [this](const std::string &name) { return globalSlotFor(name); },
+        &builtinFor);
+    prepareAnonFuncs(ast.get());
+    return Script(std::shared_ptr<const ASTNode>(std::move(ast)), this);
+}
+
+MValue Engine::run(const Script &script)
+{
+    if (!script.valid())
+        throw std::runtime_error("Cannot run an empty script");
+    if (script.owner_ != this)
+        throw std::runtime_error(
+            "Script was compiled by a different Engine; recompile it with this one");
+    return execProgram(script.ast_);
+}
+
+MValue Engine::eval(const std::string &code)
+{
+    size_t hash = std::hash<std::string>{}(code);
+    auto it = scriptCache_.find(hash);
+    if (it != scriptCache_.end() && it->second.source == code)
+        return execProgram(it->second.ast);
+
+    auto script = compile(code);
+    if (scriptCacheLimit_ > 0) {
+        if (scriptCache_.size() >= scriptCacheLimit_) {
+            scriptCache_.clear();
+            chunkCache_.clear();
+        }
+        scriptCache_[hash] = {code, script.ast_};
+    }
+    return execProgram(script.ast_);
+}
+
+MValue Engine::execProgram(const std::shared_ptr<const ASTNode> &ast)
+{
+    beginExecution();
+    if (executionMode_ == ExecutionMode::BYTECODE) {
+        auto it = chunkCache_.find(ast.get());
+        if (it == chunkCache_.end()) {
+            CachedChunk entry;
+            entry.anchor = ast;
+            auto chunk = std::make_shared<BytecodeChunk>();
+            if (BytecodeCompiler::compile(ast.get(), *this, *chunk)) {
+                entry.chunk = std::move(chunk);
+                entry.compiled = true;
+            }
+            it = chunkCache_.emplace(ast.get(), std::move(entry)).first;
+        }
+        if (it->second.compiled)
+            return execBytecode(*it->second.chunk, globalEnv_);
+    }
     return execNode(ast.get(), globalEnv_);
 }
 
+void Engine::setScriptCacheLimit(size_t limit)
+{
+    scriptCacheLimit_ = limit;
+    if (scriptCache_.size() > scriptCacheLimit_)
+        clearScriptCache();
+}
+
+void Engine::clearScriptCache()
+{
+    scriptCache_.clear();
+    chunkCache_.clear();
+    {
+        std::lock_guard<std::mutex> lock(calleeCacheMutex_);
+        calleeCache_.clear();
+    }
+}
+
+// ============================================================
+// Cooperative execution control
+// ============================================================
+void Engine::setExecBudget(uint64_t maxSteps)
+{
+    execBudget_ = maxSteps;
+}
+
+void Engine::requestInterrupt()
+{
+    interruptRequested_.store(true, std::memory_order_relaxed);
+}
+
+void Engine::beginExecution()
+{
+    stepsLeft_.store(execBudget_ > 0 ? static_cast<int64_t>(execBudget_)
+                                     : std::numeric_limits<int64_t>::max(),
+                     std::memory_order_relaxed);
+}
+
+void Engine::onBudgetExhausted()
+{
+    if (execBudget_ > 0)
+        throw BudgetExceededError();
+    stepsLeft_.store(std::numeric_limits<int64_t>::max(), std::memory_order_relaxed);
+}
+
+bool Engine::evalStep(const Script &script, size_t &cursor)
+{
+    if (!script.valid())
+        throw std::runtime_error("Cannot run an empty script");
+    if (script.owner_ != this)
+        throw std::runtime_error(
+            "Script was compiled by a different Engine; recompile it with this one");
+
+    const ASTNode *root = script.ast_.get();
+    if (root->type != NodeType::BLOCK) {
+        if (cursor > 0)
+            return false;
+        beginExecution();
+        execNode(root, globalEnv_);
+        cursor = 1;
+        return false;
+    }
+    if (cursor >= root->children.size())
+        return false;
+    beginExecution();
+    execNode(root->children[cursor].get(), globalEnv_);
+    ++cursor;
+    return cursor < root->children.size();
+}
+
 // ============================================================
 // Colon helper
 // ============================================================
@@ -238,7 +681,14 @@ std::vector<size_t> Engine::resolveIndex(const ASTNode *indexExpr,
     IndexContextGuard guard(indexContextStack_, {&array, dim, ndims});
 
     MValue val = execNode(indexExpr, env);
+    return resolveIndexValue(val, array, dim, ndims);
+}
 
+std::vector<size_t> Engine::resolveIndexValue(const MValue &val,
+                                              const MValue &array,
+                                              int dim,
+                                              int ndims)
+{
     std::vector<size_t> indices;
 
     if (val.isChar() && val.toString() == ":") {
@@ -251,12 +701,36 @@ std::vector<size_t> Engine::resolveIndex(const ASTNode *indexExpr,
 
     if (val.isLogical()) {
         const uint8_t *ld = val.logicalData();
-        for (size_t i = 0; i < val.numel(); ++i)
+        size_t n = val.numel();
+        indices.reserve(kernels::logicalCount(ld, n));
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            uint64_t w;
+            std::memcpy(&w, ld + i, 8);
+            if (!w)
+                continue; // 8 false entries at once
+            for (size_t k = 0; k < 8; ++k)
+                if (ld[i + k])
+                    indices.push_back(i + k);
+        }
+        for (; i < n; ++i)
             if (ld[i])
                 indices.push_back(i);
         return indices;
     }
 
+    if (val.isRange()) {
+        indices.reserve(val.numel());
+        for (size_t i = 0; i < val.numel(); ++i) {
+            double idx = val(i);
+            if (idx < 1.0 || idx != std::floor(idx))
+                throw std::runtime_error("Array indices must be positive integers, got "
+                                         + std::to_string(idx));
+            indices.push_back(static_cast<size_t>(idx) - 1);
+        }
+        return indices;
+    }
+
     if (val.type() == MType::DOUBLE) {
         const double *dd = val.doubleData();
         indices.reserve(val.numel());
@@ -292,6 +766,23 @@ MValue Engine::execNode(const ASTNode *node, std::shared_ptr<Environment> env)
     if (!node)
         return MValue::empty();
 
+    if (profiling_) {
+        auto t0 = std::chrono::steady_clock::now();
+        MValue result = execNodeDispatch(node, std::move(env));
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                      std::chrono::steady_clock::now() - t0)
+                      .count();
+        auto &counter = nodeProfile_[static_cast<size_t>(node->type)];
+        counter.count.fetch_add(1, std::memory_order_relaxed);
+        counter.ns.fetch_add(static_cast<uint64_t>(ns),
+                             std::memory_order_relaxed); // inclusive of children
+        return result;
+    }
+    return execNodeDispatch(node, std::move(env));
+}
+
+MValue Engine::execNodeDispatch(const ASTNode *node, std::shared_ptr<Environment> env)
+{
     switch (node->type) {
     case NodeType::BLOCK:
         return execBlock(node, env);
@@ -369,8 +860,10 @@ MValue Engine::execNode(const ASTNode *node, std::shared_ptr<Environment> env)
 MValue Engine::execBlock(const ASTNode *node, std::shared_ptr<Environment> env)
 {
     MValue last = MValue::empty();
-    for (auto &child : node->children)
+    for (auto &child : node->children) {
+        tick();
         last = execNode(child.get(), env);
+    }
     return last;
 }
 
@@ -379,8 +872,18 @@ MValue Engine::execBlock(const ASTNode *node, std::shared_ptr<Environment> env)
 // ============================================================
 MValue Engine::execIdentifier(const ASTNode *node, std::shared_ptr<Environment> env)
 {
-    const std::string &name = node->strValue;
+    if (node->slot >= 0) {
+        if (MValue *v = env->slotRead(node->slot))
+            return *v;
+        env->slotBindLocal(node->slot, node->strValue);
+        if (MValue *v = env->slotRead(node->slot))
+            return *v;
+    }
+    return loadIdentifier(node->strValue, env);
+}
 
+MValue Engine::loadIdentifier(const std::string &name, std::shared_ptr<Environment> env)
+{
     auto *val = env->get(name);
     if (val)
         return *val;
@@ -390,12 +893,17 @@ MValue Engine::execIdentifier(const ASTNode *node, std::shared_ptr<Environment>
     if (tryBuiltinCall(name, {}, env, result))
         return result;
 
+    {
+        auto fit = fastFuncIds_.find(name);
+        if (fit != fastFuncIds_.end())
+            return fastFuncs_[fit->second](nullptr, 0);
+    }
     if (externalFuncs_.count(name)) {
         auto res = externalFuncs_[name]({});
         return res.empty() ? MValue::empty() : res[0];
     }
-    if (userFuncs_.count(name))
-        return callUserFunction(userFuncs_[name], {}, env);
+    if (const UserFunction *uf = findUserFunction(name))
+        return callUserFunction(*uf, {}, env);
 
     throw std::runtime_error("Undefined variable or function: " + name);
 }
@@ -405,10 +913,26 @@ MValue Engine::execIdentifier(const ASTNode *node, std::shared_ptr<Environment>
 MValue Engine::execAssign(const ASTNode *node, std::shared_ptr<Environment> env)
 {
     auto *lhs = node->children[0].get();
-    auto rhs = execNode(node->children[1].get(), env);
+    auto *rhsNode = node->children[1].get();
+
+    // x = x <op> expr over a uniquely-owned double array updates x's
+    // buffer directly instead of allocate+copy+free.
+    if (inPlaceArithmetic_ && lhs->type == NodeType::IDENTIFIER
+        && rhsNode->type == NodeType::BINARY_OP && rhsNode->children.size() == 2
+        && rhsNode->children[0]->type == NodeType::IDENTIFIER
+        && rhsNode->children[0]->strValue == lhs->strValue) {
+        MValue result;
+        if (tryInPlaceAssign(node, lhs, rhsNode, env, result))
+            return result;
+    }
+
+    auto rhs = execNode(rhsNode, env);
 
     if (lhs->type == NodeType::IDENTIFIER) {
-        env->set(lhs->strValue, rhs);
+        if (lhs->slot >= 0)
+            env->slotWrite(lhs->slot, lhs->strValue, rhs);
+        else
+            env->set(lhs->strValue, rhs);
         if (!node->suppressOutput)
             displayValue(lhs->strValue, rhs);
     } else if (lhs->type == NodeType::CALL) {
@@ -423,6 +947,74 @@ MValue Engine::execAssign(const ASTNode *node, std::shared_ptr<Environment> env)
     return rhs;
 }
 
+bool Engine::tryInPlaceAssign(const ASTNode *node,
+                              const ASTNode *lhs,
+                              const ASTNode *binop,
+                              std::shared_ptr<Environment> env,
+                              MValue &result)
+{
+    const std::string &op = binop->strValue;
+    kernels::BinOp kop;
+    bool scalarRhsOnly = false;
+    if (op == "+")
+        kop = kernels::BinOp::ADD;
+    else if (op == "-")
+        kop = kernels::BinOp::SUB;
+    else if (op == ".*")
+        kop = kernels::BinOp::MUL;
+    else if (op == "./")
+        kop = kernels::BinOp::DIV;
+    else if (op == ".^")
+        kop = kernels::BinOp::POW;
+    else if (op == "*") {
+        kop = kernels::BinOp::MUL;
+        scalarRhsOnly = true;
+    } else if (op == "/") {
+        kop = kernels::BinOp::DIV;
+        scalarRhsOnly = true;
+    } else {
+        return false;
+    }
+
+    MValue *var = env->get(lhs->strValue);
+    if (!var || var->type() != MType::DOUBLE || var->isScalar() || var->isRange()
+        || var->bufferRefCount() != 1)
+        return false;
+
+    // From here on we complete the assignment ourselves — evaluating the
+    // rhs may have side effects and must not run twice.
+    MValue rhs = execNode(binop->children[1].get(), env);
+
+    // The rhs evaluation can reassign or clear the destination.
+    var = env->get(lhs->strValue);
+    if (var && var->type() == MType::DOUBLE && !var->isScalar() && !var->isRange()
+        && var->bufferRefCount() == 1 && rhs.type() == MType::DOUBLE
+        && (rhs.isScalar() || (!scalarRhsOnly && rhs.dims() == var->dims()))) {
+        if (rhs.isScalar())
+            kernels::binaryDoubleScalarRight(kop, var->doubleData(), rhs.toScalar(),
+                                             var->doubleDataMut(), var->numel());
+        else
+            kernels::binaryDouble(kop, var->doubleData(), rhs.doubleData(),
+                                  var->doubleDataMut(), var->numel());
+        result = *var;
+    } else {
+        // Shape/type changed underneath us: go through the operator table.
+        auto it = binaryOps_.find(op);
+        if (it == binaryOps_.end())
+            throw std::runtime_error("Undefined binary operator: " + op);
+        MValue lhsVal = var ? *var : execIdentifier(binop->children[0].get(), env);
+        result = it->second(lhsVal, rhs);
+        if (lhs->slot >= 0)
+            env->slotWrite(lhs->slot, lhs->strValue, result);
+        else
+            env->set(lhs->strValue, result);
+    }
+
+    if (!node->suppressOutput)
+        displayValue(lhs->strValue, result);
+    return true;
+}
+
 void Engine::execIndexedAssign(const ASTNode *lhs,
                                const MValue &rhs,
                                std::shared_ptr<Environment> env)
@@ -457,21 +1049,39 @@ void Engine::execIndexedAssign(const ASTNode *lhs,
     }
 
     if (nargs == 1) {
-        auto indices = resolveIndex(lhs->children[1].get(), *var, 0, 1, env);
-        for (auto idx : indices)
-            var->ensureSize(idx, &allocator_);
-        if (rhs.isScalar()) {
-            double sv = rhs.toScalar();
-            double *data = var->doubleDataMut();
+        // Scalar subscript with scalar rhs: the common A(i) = x loop
+        // pattern writes directly, no index vector.
+        {
+            IndexContextGuard guard(indexContextStack_, {var, 0, 1});
+            MValue iv = execNode(lhs->children[1].get(), env);
+            if (iv.isScalar() && iv.isNumeric() && !iv.isComplex() && rhs.isScalar()
+                && (var->type() == MType::DOUBLE || var->type() == MType::EMPTY)) {
+                double idx = iv.toScalar();
+                if (idx >= 1.0 && idx == std::floor(idx)) {
+                    size_t i = static_cast<size_t>(idx) - 1;
+                    var->ensureSize(i, &allocator_);
+                    var->doubleDataMut()[i] = rhs.toScalar();
+                    return;
+                }
+            }
+            auto indices = resolveIndexValue(iv, *var, 0, 1);
             for (auto idx : indices)
-                data[idx] = sv;
-        } else if (rhs.type() == MType::DOUBLE) {
-            const double *src = rhs.doubleData();
-            double *dst = var->doubleDataMut();
-            for (size_t i = 0; i < indices.size() && i < rhs.numel(); ++i)
-                dst[indices[i]] = src[i];
+                var->ensureSize(idx, &allocator_);
+            if (rhs.isScalar()) {
+                double sv = rhs.toScalar();
+                double *data = var->doubleDataMut();
+                for (auto idx : indices)
+                    data[idx] = sv;
+            } else if (rhs.type() == MType::DOUBLE) {
+                const double *src = rhs.doubleData();
+                double *dst = var->doubleDataMut();
+                for (size_t i = 0; i < indices.size() && i < rhs.numel(); ++i)
+                    dst[indices[i]] = src[i];
+            }
+            return;
         }
-    } else if (nargs == 2) {
+    }
+    if (nargs == 2) {
         auto rowIdx = resolveIndex(lhs->children[1].get(), *var, 0, 2, env);
         auto colIdx = resolveIndex(lhs->children[2].get(), *var, 1, 2, env);
 
@@ -505,8 +1115,9 @@ void Engine::execIndexedAssign(const ASTNode *lhs,
 
 MValue &Engine::resolveFieldLValue(const ASTNode *node, std::shared_ptr<Environment> env)
 {
+    uint32_t fieldId = node->fieldId >= 0 ? static_cast<uint32_t>(node->fieldId)
+                                          : internFieldName(node->strValue);
     auto *objNode = node->children[0].get();
-    const std::string &fieldName = node->strValue;
 
     if (objNode->type == NodeType::IDENTIFIER) {
         auto *var = env->get(objNode->strValue);
@@ -516,13 +1127,13 @@ MValue &Engine::resolveFieldLValue(const ASTNode *node, std::shared_ptr<Environm
         }
         if (!var->isStruct())
             *var = MValue::structure();
-        return var->field(fieldName);
+        return var->fieldById(fieldId);
     }
     if (objNode->type == NodeType::FIELD_ACCESS) {
         MValue &parent = resolveFieldLValue(objNode, env);
         if (!parent.isStruct())
             parent = MValue::structure();
-        return parent.field(fieldName);
+        return parent.fieldById(fieldId);
     }
     throw std::runtime_error("Invalid field assignment target");
 }
@@ -587,10 +1198,15 @@ std::vector<MValue> Engine::execCallMulti(const ASTNode *node,
     if (var && var->isFuncHandle())
         return callFuncHandleMulti(*var, args, env, nout);
 
+    {
+        auto fit = fastFuncIds_.find(funcName);
+        if (fit != fastFuncIds_.end())
+            return {fastFuncs_[fit->second](args.data(), args.size())};
+    }
     if (externalFuncs_.count(funcName))
         return externalFuncs_[funcName](args);
-    if (userFuncs_.count(funcName))
-        return callUserFunctionMulti(userFuncs_[funcName], args, env, nout);
+    if (const UserFunction *uf = findUserFunction(funcName))
+        return callUserFunctionMulti(*uf, args, env, nout);
 
     throw std::runtime_error("Undefined function: " + funcName);
 }
@@ -725,6 +1341,44 @@ MValue Engine::execUnaryOp(const ASTNode *node, std::shared_ptr<Environment> env
 // ============================================================
 // Function call / indexing
 // ============================================================
+MValue Engine::callHandle(const MValue &handle, const std::vector<MValue> &args)
+{
+    return callFuncHandle(handle, args, globalEnv_);
+}
+
+// ============================================================
+// Workspace persistence
+// ============================================================
+void Engine::saveWorkspace(const std::string &path) const
+{
+    std::ofstream os(path, std::ios::binary);
+    if (!os)
+        throw std::runtime_error("Cannot open '" + path + "' for writing");
+
+    size_t count = 0;
+    globalEnv_->forEachLocal([&](const std::string &, const MValue &) { ++count; });
+    serialize::writeHeader(os, count);
+    globalEnv_->forEachLocal([&](const std::string &name, const MValue &val) {
+        serialize::writeName(os, name);
+        serialize::writeValue(os, val);
+    });
+    if (!os)
+        throw std::runtime_error("Failed writing workspace to '" + path + "'");
+}
+
+void Engine::loadWorkspace(const std::string &path)
+{
+    std::ifstream is(path, std::ios::binary);
+    if (!is)
+        throw std::runtime_error("Cannot open '" + path + "' for reading");
+
+    size_t count = serialize::readHeader(is);
+    for (size_t i = 0; i < count; ++i) {
+        std::string name = serialize::readName(is);
+        globalEnv_->set(name, serialize::readValue(is, &allocator_));
+    }
+}
+
 MValue Engine::callFuncHandle(const MValue &handle,
                               const std::vector<MValue> &args,
                               std::shared_ptr<Environment> env)
@@ -738,11 +1392,26 @@ std::vector<MValue> Engine::callFuncHandleMulti(const MValue &handle,
                                                 std::shared_ptr<Environment> env,
                                                 size_t nout)
 {
+    // Bound target: one indirect jump, no name resolution. Handles
+    // created by another engine fall back to the name path.
+    if (handle.handleOwner() == this) {
+        if (handle.handleBuiltinId() >= 0)
+            return {fastFuncs_[handle.handleBuiltinId()](args.data(), args.size())};
+        if (handle.handleUserFunc())
+            return callUserFunctionMulti(
+                *static_cast<const UserFunction *>(handle.handleUserFunc()), args, env, nout);
+    }
+
     const std::string &name = handle.funcHandleName();
+    {
+        auto fit = fastFuncIds_.find(name);
+        if (fit != fastFuncIds_.end())
+            return {fastFuncs_[fit->second](args.data(), args.size())};
+    }
     if (externalFuncs_.count(name))
         return externalFuncs_[name](args);
-    if (userFuncs_.count(name))
-        return callUserFunctionMulti(userFuncs_[name], args, env, nout);
+    if (const UserFunction *uf = findUserFunction(name))
+        return callUserFunctionMulti(*uf, args, env, nout);
     throw std::runtime_error("Undefined function in handle: @" + name);
 }
 
@@ -764,7 +1433,8 @@ MValue Engine::execCall(const ASTNode *node, std::shared_ptr<Environment> env)
         }
 
         // Если результат — массив/cell/etc., трактуем как индексацию
-        if (target.isNumeric() || target.isLogical() || target.isChar() || target.isCell())
+        if (target.isNumeric() || target.isLogical() || target.isChar() || target.isCell()
+            || target.isStringArray())
             return execIndexAccess(target, node, env);
 
         throw std::runtime_error("Cannot call or index into value of type "
@@ -787,10 +1457,51 @@ MValue Engine::execCall(const ASTNode *node, std::shared_ptr<Environment> env)
             auto args = buildArgs();
             return callFuncHandle(*var, args, env);
         }
-        if (var->isNumeric() || var->isLogical() || var->isChar() || var->isCell())
+        if (var->isNumeric() || var->isLogical() || var->isChar() || var->isCell()
+            || var->isStringArray())
             return execIndexAccess(*var, node, env);
     }
 
+    // Direct-dispatch builtin resolved at parse time: a single indirect
+    // call with the arguments evaluated into a stack buffer.
+    if (node->builtinId >= 0 && static_cast<size_t>(node->builtinId) < fastFuncs_.size()) {
+        size_t nargs = node->children.size() - 1;
+        if (nargs <= 4) {
+            MValue argBuf[4];
+            for (size_t i = 0; i < nargs; ++i)
+                argBuf[i] = execNode(node->children[i + 1].get(), env);
+            if (profiling_) {
+                auto t0 = std::chrono::steady_clock::now();
+                MValue r = fastFuncs_[node->builtinId](argBuf, nargs);
+                recordBuiltinProfile(name,
+                                     std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                         std::chrono::steady_clock::now() - t0)
+                                         .count());
+                return r;
+            }
+            return fastFuncs_[node->builtinId](argBuf, nargs);
+        }
+        auto args = buildArgs();
+        return fastFuncs_[node->builtinId](args.data(), args.size());
+    }
+
+    // Inline cache: named user-function call sites remember their
+    // target after the first lookup (only names tryBuiltinCall does not
+    // intercept ever get cached, so command precedence is unchanged).
+    {
+        const UserFunction *cached = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(calleeCacheMutex_);
+            auto cit = calleeCache_.find(node);
+            if (cit != calleeCache_.end() && cit->second.name == name)
+                cached = cit->second.target;
+        }
+        if (cached) {
+            auto args = buildArgs();
+            return callUserFunction(*cached, args, env);
+        }
+    }
+
     // Try built-in commands (need env access)
     {
         auto args = buildArgs();
@@ -799,14 +1510,36 @@ MValue Engine::execCall(const ASTNode *node, std::shared_ptr<Environment> env)
             return result;
     }
 
+    // Fast builtins registered after this script was compiled.
+    {
+        auto fit = fastFuncIds_.find(name);
+        if (fit != fastFuncIds_.end()) {
+            auto args = buildArgs();
+            return fastFuncs_[fit->second](args.data(), args.size());
+        }
+    }
+
     if (externalFuncs_.count(name)) {
         auto args = buildArgs();
+        if (profiling_) {
+            auto t0 = std::chrono::steady_clock::now();
+            auto res = externalFuncs_[name](args);
+            recordBuiltinProfile(name,
+                                 std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                     std::chrono::steady_clock::now() - t0)
+                                     .count());
+            return res.empty() ? MValue::empty() : res[0];
+        }
         auto res = externalFuncs_[name](args);
         return res.empty() ? MValue::empty() : res[0];
     }
-    if (userFuncs_.count(name)) {
+    if (const UserFunction *uf = findUserFunction(name)) {
+        {
+            std::lock_guard<std::mutex> lock(calleeCacheMutex_);
+            calleeCache_[node] = {name, uf};
+        }
         auto args = buildArgs();
-        return callUserFunction(userFuncs_[name], args, env);
+        return callUserFunction(*uf, args, env);
     }
 
     if (var) {
@@ -823,6 +1556,45 @@ MValue Engine::execIndexAccess(const MValue &var,
 {
     size_t nargs = callNode->children.size() - 1;
 
+    // Contiguous column-major selections come back as zero-copy views:
+    // A(:) aliases the whole buffer, A(:, k) aliases one column. CoW
+    // detach materializes them only if somebody writes.
+    auto isBareColon = [](const ASTNode *n) {
+        return n->type == NodeType::COLON_EXPR && n->children.empty();
+    };
+    // Scalars (inline since the small-value optimization) have no
+    // buffer to alias; they keep the copying path below.
+    if (var.type() == MType::DOUBLE && !var.isRange() && !var.isEmpty() && !var.isScalar()) {
+        if (nargs == 1 && isBareColon(callNode->children[1].get()))
+            return MValue::view(var, 0, 1, var.numel());
+        if (nargs == 2 && isBareColon(callNode->children[1].get())
+            && !var.dims().is3D()) {
+            IndexContextGuard guard(indexContextStack_, {&var, 1, 2});
+            MValue colVal = execNode(callNode->children[2].get(), env);
+            if (colVal.isNumeric() && colVal.isScalar() && !colVal.isComplex()) {
+                double c = colVal.toScalar();
+                if (c >= 1.0 && c == std::floor(c)
+                    && static_cast<size_t>(c) <= var.dims().cols()) {
+                    size_t col = static_cast<size_t>(c) - 1;
+                    return MValue::view(var, col * var.dims().rows(), var.dims().rows(), 1);
+                }
+                throw std::runtime_error("Index exceeds array dimensions (column index)");
+            }
+            // Multi-column selection: reuse the evaluated index value.
+            auto ci = resolveIndexValue(colVal, var, 1, 2);
+            size_t R = var.dims().rows();
+            for (auto c : ci)
+                if (c >= var.dims().cols())
+                    throw std::runtime_error("Index exceeds array dimensions (column index)");
+            auto result = MValue::matrix(R, ci.size(), MType::DOUBLE, &allocator_);
+            double *dst = result.doubleDataMut();
+            const double *src = var.doubleData();
+            for (size_t cc = 0; cc < ci.size(); ++cc)
+                std::memcpy(dst + cc * R, src + ci[cc] * R, R * sizeof(double));
+            return result;
+        }
+    }
+
     // FIX #7: Bounds check helper for read-access
     auto checkBounds = [](const std::vector<size_t> &indices, size_t limit, const char *ctx) {
         for (auto idx : indices) {
@@ -833,6 +1605,29 @@ MValue Engine::execIndexAccess(const MValue &var,
         }
     };
 
+    if (var.isStringArray()) {
+        if (nargs != 1)
+            throw std::runtime_error("String array indexing supports a single subscript");
+        MValue iv;
+        {
+            IndexContextGuard guard(indexContextStack_, {&var, 0, 1});
+            iv = execNode(callNode->children[1].get(), env);
+        }
+        auto indices = resolveIndexValue(iv, var, 0, 1);
+        std::string chars;
+        std::vector<size_t> offsets;
+        offsets.reserve(indices.size() + 1);
+        offsets.push_back(0);
+        for (auto idx : indices) {
+            if (idx >= var.numel())
+                throw std::runtime_error("Index exceeds string array dimensions");
+            auto sv = var.stringAt(idx);
+            chars.append(sv.data(), sv.size());
+            offsets.push_back(chars.size());
+        }
+        return MValue::stringArrayFromPool(std::move(chars), std::move(offsets));
+    }
+
     if (var.isChar()) {
         if (nargs == 1) {
             auto indices = resolveIndex(callNode->children[1].get(), var, 0, 1, env);
@@ -873,13 +1668,42 @@ MValue Engine::execIndexAccess(const MValue &var,
         throw std::runtime_error("Cell indexing with more than 2 dimensions not supported");
     }
 
+    // Scalar subscripts are the hot pattern (A(i), A(i, j) in loops):
+    // the index expressions are evaluated once, classified, and the
+    // scalar case never builds an index vector at all; anything else
+    // reuses the evaluated value through resolveIndexValue.
+    auto scalarIndex = [](const MValue &v, size_t limit, const char *ctx) -> size_t {
+        double idx = v.toScalar();
+        if (idx < 1.0 || idx != std::floor(idx))
+            throw std::runtime_error("Array indices must be positive integers, got "
+                                     + std::to_string(idx));
+        size_t i = static_cast<size_t>(idx) - 1;
+        if (i >= limit)
+            throw std::runtime_error(std::string("Index exceeds array dimensions (") + ctx + ": "
+                                     + std::to_string(i + 1) + " > " + std::to_string(limit)
+                                     + ")");
+        return i;
+    };
+    auto isScalarSubscript = [](const MValue &v) {
+        return v.isScalar() && v.isNumeric() && !v.isComplex();
+    };
+
     if (nargs == 1) {
-        auto indices = resolveIndex(callNode->children[1].get(), var, 0, 1, env);
+        MValue iv;
+        {
+            IndexContextGuard guard(indexContextStack_, {&var, 0, 1});
+            iv = execNode(callNode->children[1].get(), env);
+        }
+        if (isScalarSubscript(iv)) {
+            size_t i = scalarIndex(iv, var.numel(), "linear index");
+            if (var.isLogical())
+                return MValue::logicalScalar(var.logicalData()[i] != 0, &allocator_);
+            return MValue::scalar(var(i), &allocator_);
+        }
+        auto indices = resolveIndexValue(iv, var, 0, 1);
         checkBounds(indices, var.numel(), "linear index");
         if (var.isLogical()) {
             const uint8_t *ld = var.logicalData();
-            if (indices.size() == 1)
-                return MValue::logicalScalar(ld[indices[0]] != 0, &allocator_);
             auto result = MValue::matrix(1, indices.size(), MType::LOGICAL, &allocator_);
             uint8_t *dst = result.logicalDataMut();
             for (size_t i = 0; i < indices.size(); ++i)
@@ -896,8 +1720,22 @@ MValue Engine::execIndexAccess(const MValue &var,
         return result;
     }
     if (nargs == 2) {
-        auto ri = resolveIndex(callNode->children[1].get(), var, 0, 2, env);
-        auto ci = resolveIndex(callNode->children[2].get(), var, 1, 2, env);
+        MValue rv, cv;
+        {
+            IndexContextGuard guard(indexContextStack_, {&var, 0, 2});
+            rv = execNode(callNode->children[1].get(), env);
+        }
+        {
+            IndexContextGuard guard(indexContextStack_, {&var, 1, 2});
+            cv = execNode(callNode->children[2].get(), env);
+        }
+        if (isScalarSubscript(rv) && isScalarSubscript(cv)) {
+            size_t r = scalarIndex(rv, var.dims().rows(), "row index");
+            size_t c = scalarIndex(cv, var.dims().cols(), "column index");
+            return MValue::scalar(var(r, c), &allocator_);
+        }
+        auto ri = resolveIndexValue(rv, var, 0, 2);
+        auto ci = resolveIndexValue(cv, var, 1, 2);
         checkBounds(ri, var.dims().rows(), "row index");
         checkBounds(ci, var.dims().cols(), "column index");
         if (ri.size() == 1 && ci.size() == 1)
@@ -966,9 +1804,12 @@ MValue Engine::execFieldAccess(const ASTNode *node, std::shared_ptr<Environment>
     if (!obj.isStruct())
         throw std::runtime_error("Dot indexing requires a struct, got "
                                  + std::string(mtypeName(obj.type())));
-    if (!obj.hasField(node->strValue))
+    const MValue *v = node->fieldId >= 0
+                          ? obj.findFieldById(static_cast<uint32_t>(node->fieldId))
+                          : obj.findFieldById(internFieldName(node->strValue));
+    if (!v)
         throw std::runtime_error("Reference to non-existent field '" + node->strValue + "'");
-    return obj.field(node->strValue);
+    return *v;
 }
 
 // ============================================================
@@ -1161,17 +2002,16 @@ MValue Engine::execColonExpr(const ASTNode *node, std::shared_ptr<Environment> e
     if (node->children.empty())
         return MValue::fromString(":", &allocator_);
 
+    // Ranges stay lazy (start/step/stop, no buffer) until a consumer
+    // needs raw data; for-loops, indexing and reductions never do.
     if (node->children.size() == 2) {
         double s = execNode(node->children[0].get(), env).toScalar();
         double e = execNode(node->children[1].get(), env).toScalar();
         size_t count = static_cast<size_t>(colonCount(s, 1.0, e));
-        auto result = MValue::matrix(1, count, MType::DOUBLE, &allocator_);
-        if (count > 0) {
-            double *dst = result.doubleDataMut();
-            for (size_t i = 0; i < count; ++i)
-                dst[i] = s + static_cast<double>(i);
-        }
-        return result;
+        // The unit-step form never clamped its last element; pass the
+        // exact final value as the stop so rangeElem reproduces that.
+        double last = count > 0 ? s + static_cast<double>(count - 1) : s;
+        return MValue::range(s, 1.0, last, count, &allocator_);
     }
 
     if (node->children.size() == 3) {
@@ -1179,20 +2019,7 @@ MValue Engine::execColonExpr(const ASTNode *node, std::shared_ptr<Environment> e
         double step = execNode(node->children[1].get(), env).toScalar();
         double e = execNode(node->children[2].get(), env).toScalar();
         size_t count = static_cast<size_t>(colonCount(s, step, e));
-        auto result = MValue::matrix(1, count, MType::DOUBLE, &allocator_);
-        if (count > 0) {
-            double *dst = result.doubleDataMut();
-            for (size_t i = 0; i < count; ++i)
-                dst[i] = s + static_cast<double>(i) * step;
-            if (count >= 2) {
-                double last = s + static_cast<double>(count - 1) * step;
-                if (step > 0 && last > e)
-                    dst[count - 1] = e;
-                if (step < 0 && last < e)
-                    dst[count - 1] = e;
-            }
-        }
-        return result;
+        return MValue::range(s, step, e, count, &allocator_);
     }
 
     return MValue::empty();
@@ -1216,19 +2043,27 @@ MValue Engine::execFor(const ASTNode *node, std::shared_ptr<Environment> env)
     const std::string &varName = node->strValue;
     auto rangeVal = execNode(node->children[0].get(), env);
 
+    auto setLoopVar = [&](MValue v) {
+        if (node->slot >= 0)
+            env->slotWrite(node->slot, varName, std::move(v));
+        else
+            env->set(varName, std::move(v));
+    };
+
     if (rangeVal.isCell()) {
         size_t cols = rangeVal.dims().cols();
         size_t rows = rangeVal.dims().rows();
         for (size_t c = 0; c < cols; ++c) {
             if (rows == 1) {
-                env->set(varName, rangeVal.cellAt(c));
+                setLoopVar(rangeVal.cellAt(c));
             } else {
                 auto col = MValue::cell(rows, 1);
                 for (size_t r = 0; r < rows; ++r)
                     col.cellAt(r) = rangeVal.cellAt(rangeVal.dims().sub2ind(r, c));
-                env->set(varName, col);
+                setLoopVar(col);
             }
             try {
+                tick();
                 execNode(node->children[1].get(), env);
             } catch (BreakSignal &) {
                 break;
@@ -1243,15 +2078,16 @@ MValue Engine::execFor(const ASTNode *node, std::shared_ptr<Environment> env)
         auto dims = rangeVal.dims();
         for (size_t c = 0; c < dims.cols(); ++c) {
             if (dims.rows() == 1) {
-                env->set(varName, MValue::scalar(rangeVal(0, c), &allocator_));
+                setLoopVar(MValue::scalar(rangeVal(0, c), &allocator_));
             } else {
                 auto col = MValue::matrix(dims.rows(), 1, MType::DOUBLE, &allocator_);
                 double *dst = col.doubleDataMut();
                 for (size_t r = 0; r < dims.rows(); ++r)
                     dst[r] = rangeVal(r, c);
-                env->set(varName, col);
+                setLoopVar(col);
             }
             try {
+                tick();
                 execNode(node->children[1].get(), env);
             } catch (BreakSignal &) {
                 break;
@@ -1265,8 +2101,9 @@ MValue Engine::execFor(const ASTNode *node, std::shared_ptr<Environment> env)
     if (rangeVal.isChar()) {
         const char *cd = rangeVal.charData();
         for (size_t i = 0; i < rangeVal.numel(); ++i) {
-            env->set(varName, MValue::fromString(std::string(1, cd[i]), &allocator_));
+            setLoopVar(MValue::fromString(std::string(1, cd[i]), &allocator_));
             try {
+                tick();
                 execNode(node->children[1].get(), env);
             } catch (BreakSignal &) {
                 break;
@@ -1280,8 +2117,9 @@ MValue Engine::execFor(const ASTNode *node, std::shared_ptr<Environment> env)
     if (rangeVal.isLogical()) {
         const uint8_t *ld = rangeVal.logicalData();
         for (size_t i = 0; i < rangeVal.numel(); ++i) {
-            env->set(varName, MValue::scalar(static_cast<double>(ld[i]), &allocator_));
+            setLoopVar(MValue::scalar(static_cast<double>(ld[i]), &allocator_));
             try {
+                tick();
                 execNode(node->children[1].get(), env);
             } catch (BreakSignal &) {
                 break;
@@ -1300,6 +2138,7 @@ MValue Engine::execWhile(const ASTNode *node, std::shared_ptr<Environment> env)
 {
     while (execNode(node->children[0].get(), env).toBool()) {
         try {
+            tick();
             execNode(node->children[1].get(), env);
         } catch (BreakSignal &) {
             break;
@@ -1364,9 +2203,16 @@ MValue Engine::execFunctionDef(const ASTNode *node, std::shared_ptr<Environment>
     func.params = node->paramNames;
     func.returns = node->returnNames;
     // Clone the body into a shared_ptr for storage in userFuncs_
-    func.body = std::shared_ptr<const ASTNode>(cloneNode(node->children[0].get()));
+    auto body = cloneNode(node->children[0].get());
+    SlotResolver::GlobalSlotFn builtinFor = [this](const std::string &name) {
+        return fastFunctionId(name);
+    };
+    func.slotCount = SlotResolver::resolveFunction(body.get(), func.params, &builtinFor);
+    prepareAnonFuncs(body.get());
+    func.body = std::shared_ptr<const ASTNode>(std::move(body));
     func.closureEnv = nullptr;
-    userFuncs_[func.name] = std::move(func);
+    std::string name = func.name;
+    storeUserFunction(name, std::move(func));
     return MValue::empty();
 }
 
@@ -1383,36 +2229,115 @@ MValue Engine::execExprStmt(const ASTNode *node, std::shared_ptr<Environment> en
 // ============================================================
 // Anonymous functions
 // ============================================================
-MValue Engine::execAnonFunc(const ASTNode *node, std::shared_ptr<Environment> env)
+// Builds the shared closure info for one ANON_FUNC node: the wrapped
+// __result__ body, its frame slot count and the free-variable list all
+// depend only on the AST.
+void Engine::prepareAnonInfo(const ASTNode *node)
 {
-    if (!node->strValue.empty() && node->children.empty())
-        return MValue::funcHandle(node->strValue, &allocator_);
-
-    int id = anonCounter_.fetch_add(1, std::memory_order_relaxed);
-    std::string anonName = "__anon_" + std::to_string(id);
-
-    UserFunction uf;
-    uf.name = anonName;
-    uf.params = node->paramNames;
-    uf.returns = {"__result__"};
+    auto info = std::make_shared<AnonFuncInfo>();
 
     // Build body block: __result__ = <cloned expression>
     auto bodyBlock = std::make_shared<ASTNode>(NodeType::BLOCK);
-
     auto assignNode = std::make_unique<ASTNode>(NodeType::ASSIGN);
     auto resultId = std::make_unique<ASTNode>(NodeType::IDENTIFIER);
     resultId->strValue = "__result__";
     assignNode->children.push_back(std::move(resultId));
     assignNode->children.push_back(cloneNode(node->children[0].get()));
     assignNode->suppressOutput = true;
-
     bodyBlock->children.push_back(std::move(assignNode));
-    uf.body = std::move(bodyBlock);
 
-    uf.closureEnv = env->snapshot(globalEnv_, &globalStore_);
+    // Re-number slots for the anonymous frame: the cloned expression
+    // may carry slot ids from the enclosing scope's numbering.
+    SlotResolver::GlobalSlotFn builtinFor = [this](const std::string &name) {
+        return fastFunctionId(name);
+    };
+    info->slotCount = SlotResolver::resolveFunction(bodyBlock.get(), node->paramNames,
+                                                    &builtinFor);
+
+    // Free variables: every referenced name except the parameters
+    // and the synthesized result slot.
+    std::vector<std::string> referenced;
+    SlotResolver::collectIdentifiers(bodyBlock.get(), referenced);
+    for (auto &name : referenced) {
+        if (name == "__result__")
+            continue;
+        if (std::find(node->paramNames.begin(), node->paramNames.end(), name)
+            != node->paramNames.end())
+            continue;
+        info->freeVars.push_back(name);
+    }
 
-    userFuncs_[anonName] = std::move(uf);
-    return MValue::funcHandle(anonName, &allocator_);
+    // Nested anonymous functions execute from the clone, so prepare
+    // their nodes too before publishing.
+    prepareAnonFuncs(bodyBlock.get());
+
+    info->body = std::move(bodyBlock);
+    node->anonInfo = std::move(info);
+}
+
+void Engine::prepareAnonFuncs(const ASTNode *node)
+{
+    if (!node)
+        return;
+    if (node->type == NodeType::ANON_FUNC && !node->children.empty()) {
+        if (!node->anonInfo)
+            prepareAnonInfo(node);
+        return; // nested anons live in the prepared clone
+    }
+    for (auto &child : node->children)
+        prepareAnonFuncs(child.get());
+    for (auto &[cond, body] : node->branches) {
+        prepareAnonFuncs(cond.get());
+        prepareAnonFuncs(body.get());
+    }
+    prepareAnonFuncs(node->elseBranch.get());
+}
+
+MValue Engine::execAnonFunc(const ASTNode *node, std::shared_ptr<Environment> env)
+{
+    if (!node->strValue.empty() && node->children.empty()) {
+        auto handle = MValue::funcHandle(node->strValue, &allocator_);
+        int builtinId = fastFunctionId(node->strValue);
+        const void *target = findUserFunction(node->strValue);
+        if (builtinId >= 0 || target)
+            handle.bindHandleTarget(this, builtinId, target);
+        return handle;
+    }
+
+    int id = anonCounter_.fetch_add(1, std::memory_order_relaxed);
+    std::string anonName = "__anon_" + std::to_string(id);
+
+    // Normally prepared eagerly at resolution time (prepareAnonFuncs);
+    // this lazy fallback only runs on single-threaded paths that bypass
+    // compile(), never on context-shared bodies.
+    if (!node->anonInfo)
+        prepareAnonInfo(node);
+
+    UserFunction uf;
+    uf.name = anonName;
+    uf.params = node->paramNames;
+    uf.returns = {"__result__"};
+    uf.body = node->anonInfo->body;
+    uf.slotCount = node->anonInfo->slotCount;
+
+    // Capture only the referenced names, by CoW MValue copy. Globals
+    // stay live through the global store; names that are not variables
+    // right now (functions, undefined) resolve at call time as before.
+    auto closureEnv = std::make_shared<Environment>(globalEnv_, &globalStore_);
+    for (auto &name : node->anonInfo->freeVars) {
+        if (env->isGlobal(name)) {
+            closureEnv->declareGlobal(name);
+            continue;
+        }
+        if (auto *v = env->get(name))
+            closureEnv->setLocal(name, *v);
+    }
+    uf.closureEnv = std::move(closureEnv);
+
+    const UserFunction *stored = storeUserFunction(anonName, std::move(uf));
+    auto handle = MValue::funcHandle(anonName, &allocator_);
+    handle.bindHandleTarget(this, -1, stored);
+    return handle;
 }
 
 // ============================================================
@@ -1428,6 +2353,10 @@ MValue Engine::execTryCatch(const ASTNode *node, std::shared_ptr<Environment> en
         throw;
     } catch (const ReturnSignal &) {
         throw;
+    } catch (const InterruptError &) {
+        throw; // host-level control flow, not catchable by scripts
+    } catch (const BudgetExceededError &) {
+        throw;
     } catch (const std::exception &e) {
         if (node->children.size() > 1) {
             if (!node->strValue.empty()) {
@@ -1475,6 +2404,7 @@ std::vector<MValue> Engine::callUserFunctionMulti(const UserFunction &func,
 
     auto parentEnv = func.closureEnv ? func.closureEnv : globalEnv_;
     auto localEnv = std::make_shared<Environment>(parentEnv, &globalStore_);
+    localEnv->reserveSlots(static_cast<size_t>(func.slotCount));
 
     for (size_t i = 0; i < func.params.size() && i < args.size(); ++i)
         localEnv->setLocal(func.params[i], args[i]);
@@ -1577,7 +2507,8 @@ bool Engine::tryBuiltinCall(const std::string &name,
         double code = 0;
         if (env->has(varName))
             code = 1; // variable
-        else if (externalFuncs_.count(varName) || userFuncs_.count(varName))
+        else if (externalFuncs_.count(varName) || findUserFunction(varName)
+                 || fastFuncIds_.count(varName))
             code = 5; // function (built-in or user)
         result = MValue::scalar(code, &allocator_);
         return true;
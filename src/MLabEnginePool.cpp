@@ -0,0 +1,54 @@
+// src/MLabEnginePool.cpp
+#include "MLabEnginePool.hpp"
+
+namespace mlab {
+
+// ============================================================
+// EngineContext
+// ============================================================
+EngineContext::EngineContext(const std::function<void(Engine &)> &setup)
+    : prototype_(new Engine())
+{
+    if (setup)
+        setup(*prototype_);
+}
+
+// ============================================================
+// EnginePool
+// ============================================================
+EnginePool::EnginePool(std::shared_ptr<EngineContext> context, size_t preallocate)
+    : context_(std::move(context))
+{
+    for (size_t i = 0; i < preallocate; ++i)
+        idle_.push_back(std::unique_ptr<Engine>(new Engine(context_)));
+}
+
+std::unique_ptr<Engine> EnginePool::acquire()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!idle_.empty()) {
+            auto engine = std::move(idle_.back());
+            idle_.pop_back();
+            return engine;
+        }
+    }
+    return std::unique_ptr<Engine>(new Engine(context_));
+}
+
+void EnginePool::release(std::unique_ptr<Engine> engine)
+{
+    if (!engine)
+        return;
+    engine->clearWorkspace();
+    std::lock_guard<std::mutex> lock(mutex_);
+    idle_.push_back(std::move(engine));
+}
+
+size_t EnginePool::idleCount() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return idle_.size();
+}
+
+} // namespace mlab
@@ -1,6 +1,8 @@
 // src/MLabEnvironment.cpp
 #include "MLabEnvironment.hpp"
 
+#include <algorithm>
+
 namespace mlab {
 
 // ============================================================
@@ -77,6 +79,8 @@ MValue *Environment::getLocal(const std::string &name)
 void Environment::declareGlobal(const std::string &name)
 {
     globals_.insert(name);
+    // A bound slot for this name would now bypass the global store.
+    std::fill(slotBindings_.begin(), slotBindings_.end(), nullptr);
 }
 
 bool Environment::isGlobal(const std::string &name) const
@@ -122,12 +126,51 @@ void Environment::remove(const std::string &name)
 {
     vars_.erase(name);
     globals_.erase(name);
+    // Erasing invalidates the cached entry address; bindings are not
+    // tracked by name, so drop them all (remove is rare).
+    std::fill(slotBindings_.begin(), slotBindings_.end(), nullptr);
 }
 
 void Environment::clearAll()
 {
     vars_.clear();
     globals_.clear();
+    std::fill(slotBindings_.begin(), slotBindings_.end(), nullptr);
+}
+
+// ============================================================
+// Slot-addressed access
+// ============================================================
+void Environment::reserveSlots(size_t n)
+{
+    if (slotBindings_.size() < n)
+        slotBindings_.resize(n, nullptr);
+}
+
+MValue *Environment::slotRead(int slot)
+{
+    return (static_cast<size_t>(slot) < slotBindings_.size()) ? slotBindings_[slot] : nullptr;
+}
+
+void Environment::slotBindLocal(int slot, const std::string &name)
+{
+    if (globals_.count(name))
+        return;
+    auto it = vars_.find(name);
+    if (it == vars_.end())
+        return;
+    reserveSlots(static_cast<size_t>(slot) + 1);
+    slotBindings_[slot] = &it->second;
+}
+
+void Environment::slotWrite(int slot, const std::string &name, MValue val)
+{
+    if (static_cast<size_t>(slot) < slotBindings_.size() && slotBindings_[slot]) {
+        *slotBindings_[slot] = std::move(val);
+        return;
+    }
+    set(name, std::move(val));
+    slotBindLocal(slot, name);
 }
 
 std::vector<std::string> Environment::localNames() const
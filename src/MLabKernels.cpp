@@ -0,0 +1,653 @@
+// src/MLabKernels.cpp
+#include "MLabKernels.hpp"
+#include "MLabThreadPool.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__)) && !defined(__EMSCRIPTEN__)
+#define MLAB_KERNELS_X86 1
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#define MLAB_KERNELS_NEON 1
+#include <arm_neon.h>
+#elif defined(__wasm_simd128__)
+#define MLAB_KERNELS_WASM 1
+#include <wasm_simd128.h>
+#endif
+
+namespace mlab {
+namespace kernels {
+
+// ============================================================
+// Scalar reference loops (tail handling + portable fallback)
+// ============================================================
+template<typename OpA, typename OpB>
+static inline void scalarLoop(const OpA &loadA, const OpB &loadB, double *dst, size_t n, BinOp op)
+{
+    switch (op) {
+    case BinOp::ADD:
+        for (size_t i = 0; i < n; ++i)
+            dst[i] = loadA(i) + loadB(i);
+        break;
+    case BinOp::SUB:
+        for (size_t i = 0; i < n; ++i)
+            dst[i] = loadA(i) - loadB(i);
+        break;
+    case BinOp::MUL:
+        for (size_t i = 0; i < n; ++i)
+            dst[i] = loadA(i) * loadB(i);
+        break;
+    case BinOp::DIV:
+        for (size_t i = 0; i < n; ++i)
+            dst[i] = loadA(i) / loadB(i);
+        break;
+    case BinOp::POW:
+        for (size_t i = 0; i < n; ++i)
+            dst[i] = std::pow(loadA(i), loadB(i));
+        break;
+    }
+}
+
+#if defined(MLAB_KERNELS_X86)
+
+// ============================================================
+// AVX2 variants (selected at runtime; pow stays scalar)
+// ============================================================
+__attribute__((target("avx2,fma"))) static void binaryAvx2(
+    BinOp op, const double *a, const double *b, double *dst, size_t n)
+{
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256d va = _mm256_loadu_pd(a + i);
+        __m256d vb = _mm256_loadu_pd(b + i);
+        __m256d vr;
+        switch (op) {
+        case BinOp::ADD:
+            vr = _mm256_add_pd(va, vb);
+            break;
+        case BinOp::SUB:
+            vr = _mm256_sub_pd(va, vb);
+            break;
+        case BinOp::MUL:
+            vr = _mm256_mul_pd(va, vb);
+            break;
+        default:
+            vr = _mm256_div_pd(va, vb);
+            break;
+        }
+        _mm256_storeu_pd(dst + i, vr);
+    }
+    scalarLoop([&](size_t k) { return a[i + k]; },
+               [&](size_t k) { return b[i + k]; },
+               dst + i,
+               n - i,
+               op);
+}
+
+__attribute__((target("avx2,fma"))) static void binaryAvx2ScalarLeft(
+    BinOp op, double a, const double *b, double *dst, size_t n)
+{
+    __m256d va = _mm256_set1_pd(a);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256d vb = _mm256_loadu_pd(b + i);
+        __m256d vr;
+        switch (op) {
+        case BinOp::ADD:
+            vr = _mm256_add_pd(va, vb);
+            break;
+        case BinOp::SUB:
+            vr = _mm256_sub_pd(va, vb);
+            break;
+        case BinOp::MUL:
+            vr = _mm256_mul_pd(va, vb);
+            break;
+        default:
+            vr = _mm256_div_pd(va, vb);
+            break;
+        }
+        _mm256_storeu_pd(dst + i, vr);
+    }
+    scalarLoop([&](size_t) { return a; },
+               [&](size_t k) { return b[i + k]; },
+               dst + i,
+               n - i,
+               op);
+}
+
+__attribute__((target("avx2,fma"))) static void binaryAvx2ScalarRight(
+    BinOp op, const double *a, double b, double *dst, size_t n)
+{
+    __m256d vb = _mm256_set1_pd(b);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256d va = _mm256_loadu_pd(a + i);
+        __m256d vr;
+        switch (op) {
+        case BinOp::ADD:
+            vr = _mm256_add_pd(va, vb);
+            break;
+        case BinOp::SUB:
+            vr = _mm256_sub_pd(va, vb);
+            break;
+        case BinOp::MUL:
+            vr = _mm256_mul_pd(va, vb);
+            break;
+        default:
+            vr = _mm256_div_pd(va, vb);
+            break;
+        }
+        _mm256_storeu_pd(dst + i, vr);
+    }
+    scalarLoop([&](size_t k) { return a[i + k]; },
+               [&](size_t) { return b; },
+               dst + i,
+               n - i,
+               op);
+}
+
+static bool haveAvx2()
+{
+    static const bool avx2 = __builtin_cpu_supports("avx2");
+    return avx2;
+}
+
+#elif defined(MLAB_KERNELS_NEON)
+
+// ============================================================
+// NEON variants (baseline on aarch64)
+// ============================================================
+static inline float64x2_t neonApply(BinOp op, float64x2_t va, float64x2_t vb)
+{
+    switch (op) {
+    case BinOp::ADD:
+        return vaddq_f64(va, vb);
+    case BinOp::SUB:
+        return vsubq_f64(va, vb);
+    case BinOp::MUL:
+        return vmulq_f64(va, vb);
+    default:
+        return vdivq_f64(va, vb);
+    }
+}
+
+static void binaryNeon(BinOp op, const double *a, const double *b, double *dst, size_t n)
+{
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2)
+        vst1q_f64(dst + i, neonApply(op, vld1q_f64(a + i), vld1q_f64(b + i)));
+    scalarLoop([&](size_t k) { return a[i + k]; },
+               [&](size_t k) { return b[i + k]; },
+               dst + i,
+               n - i,
+               op);
+}
+
+static void binaryNeonScalarLeft(BinOp op, double a, const double *b, double *dst, size_t n)
+{
+    float64x2_t va = vdupq_n_f64(a);
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2)
+        vst1q_f64(dst + i, neonApply(op, va, vld1q_f64(b + i)));
+    scalarLoop([&](size_t) { return a; },
+               [&](size_t k) { return b[i + k]; },
+               dst + i,
+               n - i,
+               op);
+}
+
+static void binaryNeonScalarRight(BinOp op, const double *a, double b, double *dst, size_t n)
+{
+    float64x2_t vb = vdupq_n_f64(b);
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2)
+        vst1q_f64(dst + i, neonApply(op, vld1q_f64(a + i), vb));
+    scalarLoop([&](size_t k) { return a[i + k]; },
+               [&](size_t) { return b; },
+               dst + i,
+               n - i,
+               op);
+}
+
+#elif defined(MLAB_KERNELS_WASM)
+
+// ============================================================
+// wasm SIMD128 variants
+// ============================================================
+static inline v128_t wasmApply(BinOp op, v128_t va, v128_t vb)
+{
+    switch (op) {
+    case BinOp::ADD:
+        return wasm_f64x2_add(va, vb);
+    case BinOp::SUB:
+        return wasm_f64x2_sub(va, vb);
+    case BinOp::MUL:
+        return wasm_f64x2_mul(va, vb);
+    default:
+        return wasm_f64x2_div(va, vb);
+    }
+}
+
+static void binaryWasm(BinOp op, const double *a, const double *b, double *dst, size_t n)
+{
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2)
+        wasm_v128_store(dst + i, wasmApply(op, wasm_v128_load(a + i), wasm_v128_load(b + i)));
+    scalarLoop([&](size_t k) { return a[i + k]; },
+               [&](size_t k) { return b[i + k]; },
+               dst + i,
+               n - i,
+               op);
+}
+
+static void binaryWasmScalarLeft(BinOp op, double a, const double *b, double *dst, size_t n)
+{
+    v128_t va = wasm_f64x2_splat(a);
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2)
+        wasm_v128_store(dst + i, wasmApply(op, va, wasm_v128_load(b + i)));
+    scalarLoop([&](size_t) { return a; },
+               [&](size_t k) { return b[i + k]; },
+               dst + i,
+               n - i,
+               op);
+}
+
+static void binaryWasmScalarRight(BinOp op, const double *a, double b, double *dst, size_t n)
+{
+    v128_t vb = wasm_f64x2_splat(b);
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2)
+        wasm_v128_store(dst + i, wasmApply(op, wasm_v128_load(a + i), vb));
+    scalarLoop([&](size_t k) { return a[i + k]; },
+               [&](size_t) { return b; },
+               dst + i,
+               n - i,
+               op);
+}
+
+#endif
+
+// ============================================================
+// Public entry points with runtime selection
+// ============================================================
+void binaryDouble(BinOp op, const double *a, const double *b, double *dst, size_t n)
+{
+#if defined(MLAB_KERNELS_X86)
+    if (op != BinOp::POW && haveAvx2()) {
+        binaryAvx2(op, a, b, dst, n);
+        return;
+    }
+#elif defined(MLAB_KERNELS_NEON)
+    if (op != BinOp::POW) {
+        binaryNeon(op, a, b, dst, n);
+        return;
+    }
+#elif defined(MLAB_KERNELS_WASM)
+    if (op != BinOp::POW) {
+        binaryWasm(op, a, b, dst, n);
+        return;
+    }
+#endif
+    scalarLoop([&](size_t i) { return a[i]; }, [&](size_t i) { return b[i]; }, dst, n, op);
+}
+
+void binaryDoubleScalarLeft(BinOp op, double a, const double *b, double *dst, size_t n)
+{
+#if defined(MLAB_KERNELS_X86)
+    if (op != BinOp::POW && haveAvx2()) {
+        binaryAvx2ScalarLeft(op, a, b, dst, n);
+        return;
+    }
+#elif defined(MLAB_KERNELS_NEON)
+    if (op != BinOp::POW) {
+        binaryNeonScalarLeft(op, a, b, dst, n);
+        return;
+    }
+#elif defined(MLAB_KERNELS_WASM)
+    if (op != BinOp::POW) {
+        binaryWasmScalarLeft(op, a, b, dst, n);
+        return;
+    }
+#endif
+    scalarLoop([&](size_t) { return a; }, [&](size_t i) { return b[i]; }, dst, n, op);
+}
+
+void binaryDoubleScalarRight(BinOp op, const double *a, double b, double *dst, size_t n)
+{
+#if defined(MLAB_KERNELS_X86)
+    if (op != BinOp::POW && haveAvx2()) {
+        binaryAvx2ScalarRight(op, a, b, dst, n);
+        return;
+    }
+#elif defined(MLAB_KERNELS_NEON)
+    if (op != BinOp::POW) {
+        binaryNeonScalarRight(op, a, b, dst, n);
+        return;
+    }
+#elif defined(MLAB_KERNELS_WASM)
+    if (op != BinOp::POW) {
+        binaryWasmScalarRight(op, a, b, dst, n);
+        return;
+    }
+#endif
+    scalarLoop([&](size_t i) { return a[i]; }, [&](size_t) { return b; }, dst, n, op);
+}
+
+// ============================================================
+// Comparisons — predicate hoisted, mask output
+// ============================================================
+template<typename LoadA, typename LoadB>
+static inline void compareLoop(
+    CmpOp op, const LoadA &la, const LoadB &lb, uint8_t *dst, size_t n)
+{
+    switch (op) {
+    case CmpOp::EQ:
+        for (size_t i = 0; i < n; ++i)
+            dst[i] = la(i) == lb(i) ? 1 : 0;
+        break;
+    case CmpOp::NE:
+        for (size_t i = 0; i < n; ++i)
+            dst[i] = la(i) != lb(i) ? 1 : 0;
+        break;
+    case CmpOp::LT:
+        for (size_t i = 0; i < n; ++i)
+            dst[i] = la(i) < lb(i) ? 1 : 0;
+        break;
+    case CmpOp::GT:
+        for (size_t i = 0; i < n; ++i)
+            dst[i] = la(i) > lb(i) ? 1 : 0;
+        break;
+    case CmpOp::LE:
+        for (size_t i = 0; i < n; ++i)
+            dst[i] = la(i) <= lb(i) ? 1 : 0;
+        break;
+    case CmpOp::GE:
+        for (size_t i = 0; i < n; ++i)
+            dst[i] = la(i) >= lb(i) ? 1 : 0;
+        break;
+    }
+}
+
+void compareDouble(CmpOp op, const double *a, const double *b, uint8_t *dst, size_t n)
+{
+    compareLoop(op, [&](size_t i) { return a[i]; }, [&](size_t i) { return b[i]; }, dst, n);
+}
+
+void compareDoubleScalarLeft(CmpOp op, double a, const double *b, uint8_t *dst, size_t n)
+{
+    compareLoop(op, [&](size_t) { return a; }, [&](size_t i) { return b[i]; }, dst, n);
+}
+
+void compareDoubleScalarRight(CmpOp op, const double *a, double b, uint8_t *dst, size_t n)
+{
+    compareLoop(op, [&](size_t i) { return a[i]; }, [&](size_t) { return b; }, dst, n);
+}
+
+// ============================================================
+// Logical mask kernels — uint64 word per eight mask bytes
+// ============================================================
+namespace {
+constexpr uint64_t kOnesBytes = 0x0101010101010101ull;
+
+inline uint64_t loadWord(const uint8_t *p)
+{
+    uint64_t w;
+    std::memcpy(&w, p, sizeof(w));
+    return w;
+}
+
+inline void storeWord(uint8_t *p, uint64_t w)
+{
+    std::memcpy(p, &w, sizeof(w));
+}
+} // namespace
+
+void logicalAnd(const uint8_t *a, const uint8_t *b, uint8_t *dst, size_t n)
+{
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+        storeWord(dst + i, loadWord(a + i) & loadWord(b + i));
+    for (; i < n; ++i)
+        dst[i] = a[i] & b[i];
+}
+
+void logicalOr(const uint8_t *a, const uint8_t *b, uint8_t *dst, size_t n)
+{
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+        storeWord(dst + i, loadWord(a + i) | loadWord(b + i));
+    for (; i < n; ++i)
+        dst[i] = a[i] | b[i];
+}
+
+void logicalNot(const uint8_t *a, uint8_t *dst, size_t n)
+{
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+        storeWord(dst + i, loadWord(a + i) ^ kOnesBytes);
+    for (; i < n; ++i)
+        dst[i] = a[i] ^ 1;
+}
+
+size_t logicalCount(const uint8_t *a, size_t n)
+{
+    size_t count = 0;
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        uint64_t w = loadWord(a + i);
+        if (w) {
+#if defined(__GNUC__) || defined(__clang__)
+            count += static_cast<size_t>(__builtin_popcountll(w));
+#else
+            for (int k = 0; k < 8; ++k)
+                count += (w >> (k * 8)) & 1;
+#endif
+        }
+    }
+    for (; i < n; ++i)
+        count += a[i] ? 1 : 0;
+    return count;
+}
+
+// ============================================================
+// Reductions
+// ============================================================
+namespace {
+constexpr size_t kPairwiseBlock = 128;
+constexpr size_t kReduceParallelThreshold = size_t(1) << 20;
+
+double sumPairwise(const double *a, size_t n)
+{
+    if (n <= kPairwiseBlock) {
+        double s = 0;
+        for (size_t i = 0; i < n; ++i)
+            s += a[i];
+        return s;
+    }
+    size_t half = n / 2;
+    return sumPairwise(a, half) + sumPairwise(a + half, n - half);
+}
+} // namespace
+
+double reduceSum(const double *a, size_t n)
+{
+    if (n >= kReduceParallelThreshold && ThreadPool::global().numThreads() > 0) {
+        std::mutex m;
+        double total = 0;
+        ThreadPool::global().parallelFor(0, n, kReduceParallelThreshold / 4,
+                                         [&](size_t lo, size_t hi) {
+                                             double part = sumPairwise(a + lo, hi - lo);
+                                             std::lock_guard<std::mutex> lock(m);
+                                             total += part;
+                                         });
+        return total;
+    }
+    return sumPairwise(a, n);
+}
+
+double reduceProd(const double *a, size_t n)
+{
+    double p = 1;
+    for (size_t i = 0; i < n; ++i)
+        p *= a[i];
+    return p;
+}
+
+double reduceSumStrided(const double *a, size_t n, size_t stride)
+{
+    double s = 0;
+    for (size_t i = 0; i < n; ++i)
+        s += a[i * stride];
+    return s;
+}
+
+double reduceProdStrided(const double *a, size_t n, size_t stride)
+{
+    double p = 1;
+    for (size_t i = 0; i < n; ++i)
+        p *= a[i * stride];
+    return p;
+}
+
+void reduceMin(const double *a, size_t n, double &val, size_t &idx)
+{
+    val = a[0];
+    idx = 0;
+    for (size_t i = 1; i < n; ++i)
+        if (a[i] < val) {
+            val = a[i];
+            idx = i;
+        }
+}
+
+void reduceMax(const double *a, size_t n, double &val, size_t &idx)
+{
+    val = a[0];
+    idx = 0;
+    for (size_t i = 1; i < n; ++i)
+        if (a[i] > val) {
+            val = a[i];
+            idx = i;
+        }
+}
+
+double reduceMinStrided(const double *a, size_t n, size_t stride)
+{
+    double v = a[0];
+    for (size_t i = 1; i < n; ++i)
+        v = std::min(v, a[i * stride]);
+    return v;
+}
+
+double reduceMaxStrided(const double *a, size_t n, size_t stride)
+{
+    double v = a[0];
+    for (size_t i = 1; i < n; ++i)
+        v = std::max(v, a[i * stride]);
+    return v;
+}
+
+// ============================================================
+// Matrix multiply — cache-blocked, column-major
+// ============================================================
+// Column blocks of C are independent, so they parallelize cleanly; the
+// k-blocking keeps the touched panel of A in cache, and the 4-way k
+// unroll accumulates into one stride-1 pass over the C column (axpy
+// form), which the compiler turns into packed FMA.
+namespace {
+constexpr size_t kMatmulBlockK = 256;
+constexpr size_t kMatmulBlockN = 64;
+// Below this many multiply-adds threading overhead dominates.
+constexpr size_t kMatmulParallelFlops = size_t(1) << 21;
+} // namespace
+
+static void matmulDoubleCols(
+    const double *a, const double *b, double *c, size_t M, size_t K, size_t jBegin, size_t jEnd)
+{
+    for (size_t jj = jBegin; jj < jEnd; jj += kMatmulBlockN) {
+        size_t jMax = std::min(jj + kMatmulBlockN, jEnd);
+        for (size_t kk = 0; kk < K; kk += kMatmulBlockK) {
+            size_t kMax = std::min(kk + kMatmulBlockK, K);
+            for (size_t j = jj; j < jMax; ++j) {
+                double *cj = c + j * M;
+                const double *bj = b + j * K;
+                size_t k = kk;
+                for (; k + 4 <= kMax; k += 4) {
+                    const double b0 = bj[k], b1 = bj[k + 1];
+                    const double b2 = bj[k + 2], b3 = bj[k + 3];
+                    const double *a0 = a + k * M;
+                    const double *a1 = a0 + M;
+                    const double *a2 = a1 + M;
+                    const double *a3 = a2 + M;
+                    for (size_t i = 0; i < M; ++i)
+                        cj[i] += a0[i] * b0 + a1[i] * b1 + a2[i] * b2 + a3[i] * b3;
+                }
+                for (; k < kMax; ++k) {
+                    const double bk = bj[k];
+                    const double *ak = a + k * M;
+                    for (size_t i = 0; i < M; ++i)
+                        cj[i] += ak[i] * bk;
+                }
+            }
+        }
+    }
+}
+
+void matmulDouble(const double *a, const double *b, double *c, size_t M, size_t K, size_t N)
+{
+    if (M * K * N >= kMatmulParallelFlops) {
+        ThreadPool::global().parallelFor(0, N, kMatmulBlockN, [&](size_t lo, size_t hi) {
+            matmulDoubleCols(a, b, c, M, K, lo, hi);
+        });
+    } else {
+        matmulDoubleCols(a, b, c, M, K, 0, N);
+    }
+}
+
+static void matmulComplexCols(const std::complex<double> *a,
+                              const std::complex<double> *b,
+                              std::complex<double> *c,
+                              size_t M,
+                              size_t K,
+                              size_t jBegin,
+                              size_t jEnd)
+{
+    for (size_t jj = jBegin; jj < jEnd; jj += kMatmulBlockN) {
+        size_t jMax = std::min(jj + kMatmulBlockN, jEnd);
+        for (size_t kk = 0; kk < K; kk += kMatmulBlockK) {
+            size_t kMax = std::min(kk + kMatmulBlockK, K);
+            for (size_t j = jj; j < jMax; ++j) {
+                std::complex<double> *cj = c + j * M;
+                const std::complex<double> *bj = b + j * K;
+                for (size_t k = kk; k < kMax; ++k) {
+                    const std::complex<double> bk = bj[k];
+                    const std::complex<double> *ak = a + k * M;
+                    for (size_t i = 0; i < M; ++i)
+                        cj[i] += ak[i] * bk;
+                }
+            }
+        }
+    }
+}
+
+void matmulComplex(const std::complex<double> *a,
+                   const std::complex<double> *b,
+                   std::complex<double> *c,
+                   size_t M,
+                   size_t K,
+                   size_t N)
+{
+    if (M * K * N >= kMatmulParallelFlops) {
+        ThreadPool::global().parallelFor(0, N, kMatmulBlockN, [&](size_t lo, size_t hi) {
+            matmulComplexCols(a, b, c, M, K, lo, hi);
+        });
+    } else {
+        matmulComplexCols(a, b, c, M, K, 0, N);
+    }
+}
+
+} // namespace kernels
+} // namespace mlab
@@ -1,7 +1,6 @@
 #include "MLabLexer.hpp"
 
 #include <stdexcept>
-#include <unordered_map>
 
 namespace mlab {
 
@@ -74,7 +73,7 @@ char Lexer::advance()
     return c;
 }
 
-void Lexer::addToken(TokenType type, const std::string &val, int line, int col)
+void Lexer::addToken(TokenType type, std::string_view val, int line, int col)
 {
     tokens_.push_back({type, val, line, col});
 }
@@ -333,13 +332,13 @@ void Lexer::readNumber()
             if (!isAlnum(afterSuffix) && afterSuffix != '_') {
                 advance();
                 addToken(TokenType::IMAG_NUMBER,
-                         src_.substr(start, pos_ - start),
+                         std::string_view(src_.data() + start, pos_ - start),
                          startLine,
                          startCol);
                 return;
             }
         }
-        addToken(TokenType::NUMBER, src_.substr(start, pos_ - start), startLine, startCol);
+        addToken(TokenType::NUMBER, std::string_view(src_.data() + start, pos_ - start), startLine, startCol);
         return;
     }
 
@@ -358,13 +357,13 @@ void Lexer::readNumber()
             if (!isAlnum(afterSuffix) && afterSuffix != '_') {
                 advance();
                 addToken(TokenType::IMAG_NUMBER,
-                         src_.substr(start, pos_ - start),
+                         std::string_view(src_.data() + start, pos_ - start),
                          startLine,
                          startCol);
                 return;
             }
         }
-        addToken(TokenType::NUMBER, src_.substr(start, pos_ - start), startLine, startCol);
+        addToken(TokenType::NUMBER, std::string_view(src_.data() + start, pos_ - start), startLine, startCol);
         return;
     }
 
@@ -383,13 +382,13 @@ void Lexer::readNumber()
             if (!isAlnum(afterSuffix) && afterSuffix != '_') {
                 advance();
                 addToken(TokenType::IMAG_NUMBER,
-                         src_.substr(start, pos_ - start),
+                         std::string_view(src_.data() + start, pos_ - start),
                          startLine,
                          startCol);
                 return;
             }
         }
-        addToken(TokenType::NUMBER, src_.substr(start, pos_ - start), startLine, startCol);
+        addToken(TokenType::NUMBER, std::string_view(src_.data() + start, pos_ - start), startLine, startCol);
         return;
     }
 
@@ -449,12 +448,12 @@ void Lexer::readNumber()
         char afterSuffix = peek(1);
         if (!isAlnum(afterSuffix) && afterSuffix != '_') {
             advance();
-            addToken(TokenType::IMAG_NUMBER, src_.substr(start, pos_ - start), startLine, startCol);
+            addToken(TokenType::IMAG_NUMBER, std::string_view(src_.data() + start, pos_ - start), startLine, startCol);
             return;
         }
     }
 
-    addToken(TokenType::NUMBER, src_.substr(start, pos_ - start), startLine, startCol);
+    addToken(TokenType::NUMBER, std::string_view(src_.data() + start, pos_ - start), startLine, startCol);
 }
 
 // ─── read single-quoted string ──────────────────────────────────────────
@@ -462,6 +461,29 @@ void Lexer::readNumber()
 void Lexer::readString(int startLine, int startCol)
 {
     advance();
+    size_t start = pos_;
+    int colAtStart = col_;
+
+    // Fast path: no doubled quotes — the token views the source directly.
+    while (pos_ < src_.size()) {
+        if (peek() == '\'') {
+            if (peek(1) == '\'')
+                break; // '' escape → copy path below
+            std::string_view sv(src_.data() + start, pos_ - start);
+            advance();
+            addToken(TokenType::STRING, sv, startLine, startCol);
+            return;
+        }
+        if (peek() == '\n')
+            error("Unterminated string literal", startLine, startCol);
+        advance();
+    }
+    if (pos_ >= src_.size())
+        error("Unterminated string literal", startLine, startCol);
+
+    // Copy path: rescan, collapsing '' into the side buffer.
+    pos_ = start;
+    col_ = colAtStart;
     std::string s;
     while (pos_ < src_.size()) {
         if (peek() == '\'') {
@@ -471,7 +493,8 @@ void Lexer::readString(int startLine, int startCol)
                 advance();
             } else {
                 advance();
-                addToken(TokenType::STRING, s, startLine, startCol);
+                ownedStrings_.push_back(std::move(s));
+                addToken(TokenType::STRING, ownedStrings_.back(), startLine, startCol);
                 return;
             }
         } else if (peek() == '\n') {
@@ -488,6 +511,31 @@ void Lexer::readString(int startLine, int startCol)
 void Lexer::readDoubleQuotedString(int startLine, int startCol)
 {
     advance();
+    size_t start = pos_;
+    int colAtStart = col_;
+
+    // Fast path: no escapes and no doubled quotes.
+    while (pos_ < src_.size()) {
+        if (peek() == '"') {
+            if (peek(1) == '"')
+                break;
+            std::string_view sv(src_.data() + start, pos_ - start);
+            advance();
+            addToken(TokenType::STRING, sv, startLine, startCol);
+            return;
+        }
+        if (peek() == '\\')
+            break;
+        if (peek() == '\n')
+            error("Unterminated string literal", startLine, startCol);
+        advance();
+    }
+    if (pos_ >= src_.size())
+        error("Unterminated string literal", startLine, startCol);
+
+    // Copy path: rescan with escape processing into the side buffer.
+    pos_ = start;
+    col_ = colAtStart;
     std::string s;
     while (pos_ < src_.size()) {
         if (peek() == '"') {
@@ -497,7 +545,8 @@ void Lexer::readDoubleQuotedString(int startLine, int startCol)
                 advance();
             } else {
                 advance();
-                addToken(TokenType::STRING, s, startLine, startCol);
+                ownedStrings_.push_back(std::move(s));
+                addToken(TokenType::STRING, ownedStrings_.back(), startLine, startCol);
                 return;
             }
         } else if (peek() == '\\') {
@@ -561,9 +610,14 @@ void Lexer::readIdentifier()
     while (pos_ < src_.size() && (isAlnum(peek()) || peek() == '_'))
         advance();
 
-    std::string word = src_.substr(start, pos_ - start);
+    std::string_view word(src_.data() + start, pos_ - start);
 
-    static const std::unordered_map<std::string, TokenType> keywords = {
+    struct Keyword
+    {
+        std::string_view name;
+        TokenType type;
+    };
+    static const Keyword keywords[] = {
         {"if", TokenType::KW_IF},
         {"elseif", TokenType::KW_ELSEIF},
         {"else", TokenType::KW_ELSE},
@@ -585,11 +639,13 @@ void Lexer::readIdentifier()
         {"persistent", TokenType::KW_PERSISTENT},
     };
 
-    auto it = keywords.find(word);
-    if (it != keywords.end())
-        addToken(it->second, word, startLine, startCol);
-    else
-        addToken(TokenType::IDENTIFIER, word, startLine, startCol);
+    for (const auto &kw : keywords) {
+        if (word == kw.name) {
+            addToken(kw.type, word, startLine, startCol);
+            return;
+        }
+    }
+    addToken(TokenType::IDENTIFIER, word, startLine, startCol);
 }
 
 // ─── read operators / punctuation ───────────────────────────────────────
@@ -700,9 +756,12 @@ std::vector<Token> Lexer::tokenize()
 {
     tokens_.clear();
     bracketStack_.clear();
+    ownedStrings_.clear();
     pos_ = 0;
     line_ = 1;
     col_ = 1;
+    // Rough density heuristic: one token per ~4 source characters.
+    tokens_.reserve(src_.size() / 4 + 8);
 
     while (pos_ < src_.size()) {
         skipSpacesAndComments();
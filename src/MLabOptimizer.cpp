@@ -0,0 +1,162 @@
+// src/MLabOptimizer.cpp
+#include "MLabOptimizer.hpp"
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+namespace mlab {
+
+void ASTOptimizer::run(ASTNode *root)
+{
+    optimizeNode(root);
+}
+
+bool ASTOptimizer::constValue(const ASTNode *node, double &out)
+{
+    if (node->type == NodeType::NUMBER_LITERAL) {
+        out = node->numValue;
+        return true;
+    }
+    if (node->type == NodeType::BOOL_LITERAL) {
+        out = node->boolValue ? 1.0 : 0.0;
+        return true;
+    }
+    return false;
+}
+
+void ASTOptimizer::optimizeNode(ASTNode *node)
+{
+    if (!node)
+        return;
+
+    // Bottom-up: fold the operands first.
+    for (auto &child : node->children)
+        optimizeNode(child.get());
+    for (auto &[cond, body] : node->branches) {
+        optimizeNode(cond.get());
+        optimizeNode(body.get());
+    }
+    optimizeNode(node->elseBranch.get());
+
+    switch (node->type) {
+    case NodeType::UNARY_OP:
+        foldUnary(node);
+        break;
+    case NodeType::BINARY_OP:
+        foldBinary(node);
+        break;
+    case NodeType::IF_STMT:
+        pruneIf(node);
+        break;
+    default:
+        break;
+    }
+}
+
+void ASTOptimizer::foldUnary(ASTNode *node)
+{
+    if (node->children.size() != 1 || node->children[0]->type != NodeType::NUMBER_LITERAL)
+        return;
+    double v = node->children[0]->numValue;
+    if (node->strValue == "-") {
+        node->type = NodeType::NUMBER_LITERAL;
+        node->numValue = -v;
+    } else if (node->strValue == "+") {
+        node->type = NodeType::NUMBER_LITERAL;
+        node->numValue = v;
+    } else {
+        return;
+    }
+    node->strValue.clear();
+    node->children.clear();
+}
+
+void ASTOptimizer::foldBinary(ASTNode *node)
+{
+    if (node->children.size() != 2)
+        return;
+    const ASTNode *lhs = node->children[0].get();
+    const ASTNode *rhs = node->children[1].get();
+    const std::string &op = node->strValue;
+
+    // Arithmetic folds only over plain number literals — the stdlib
+    // rejects arithmetic on logicals, so BOOL_LITERAL stays put there.
+    if (lhs->type == NodeType::NUMBER_LITERAL && rhs->type == NodeType::NUMBER_LITERAL) {
+        double a = lhs->numValue, b = rhs->numValue;
+        double result;
+        if (op == "+")
+            result = a + b;
+        else if (op == "-")
+            result = a - b;
+        else if (op == "*" || op == ".*")
+            result = a * b;
+        else if (op == "/" || op == "./")
+            result = a / b;
+        else if (op == "^" || op == ".^")
+            result = std::pow(a, b);
+        else
+            result = 0;
+        if (op == "+" || op == "-" || op == "*" || op == ".*" || op == "/" || op == "./"
+            || op == "^" || op == ".^") {
+            node->type = NodeType::NUMBER_LITERAL;
+            node->numValue = result;
+            node->strValue.clear();
+            node->children.clear();
+            return;
+        }
+    }
+
+    // Comparisons and short-circuit logic fold over numbers and bools.
+    double a, b;
+    if (!constValue(lhs, a) || !constValue(rhs, b))
+        return;
+
+    bool result;
+    if (op == "==")
+        result = a == b;
+    else if (op == "~=")
+        result = a != b;
+    else if (op == "<")
+        result = a < b;
+    else if (op == ">")
+        result = a > b;
+    else if (op == "<=")
+        result = a <= b;
+    else if (op == ">=")
+        result = a >= b;
+    else if (op == "&&")
+        result = (a != 0.0) && (b != 0.0);
+    else if (op == "||")
+        result = (a != 0.0) || (b != 0.0);
+    else
+        return;
+
+    node->type = NodeType::BOOL_LITERAL;
+    node->boolValue = result;
+    node->strValue.clear();
+    node->children.clear();
+}
+
+void ASTOptimizer::pruneIf(ASTNode *node)
+{
+    std::vector<std::pair<ASTNodePtr, ASTNodePtr>> kept;
+    kept.reserve(node->branches.size());
+
+    for (auto &[cond, body] : node->branches) {
+        double v;
+        if (constValue(cond.get(), v)) {
+            if (v == 0.0)
+                continue; // branch can never run
+            // Constant-true branch: everything after it is unreachable.
+            kept.emplace_back(std::move(cond), std::move(body));
+            node->branches = std::move(kept);
+            node->elseBranch.reset();
+            return;
+        }
+        kept.emplace_back(std::move(cond), std::move(body));
+    }
+    node->branches = std::move(kept);
+}
+
+} // namespace mlab
@@ -73,7 +73,7 @@ Token Parser::consume(TokenType t, const std::string &msg)
                                        : msg;
     throw std::runtime_error("Parse error at line " + std::to_string(current().line) + " col "
                              + std::to_string(current().col) + ": expected " + expected + ", got '"
-                             + current().value + "'");
+                             + std::string(current().value) + "'");
 }
 
 void Parser::skipNewlines()
@@ -104,7 +104,7 @@ bool Parser::isTerminator(std::initializer_list<TokenType> terminators) const
 // Обрабатывает hex (0x), binary (0b), octal (0o), подчёркивания
 // ============================================================
 
-double Parser::parseDouble(const std::string &text, int line, int col)
+double Parser::parseDouble(std::string_view text, int line, int col)
 {
     // Убираем подчёркивания и суффикс i/j (для мнимых)
     std::string clean;
@@ -119,7 +119,7 @@ double Parser::parseDouble(const std::string &text, int line, int col)
         clean.pop_back();
 
     if (clean.empty()) {
-        throw std::runtime_error("Invalid number literal '" + text + "' at line "
+        throw std::runtime_error("Invalid number literal '" + std::string(text) + "' at line "
                                  + std::to_string(line) + " col " + std::to_string(col));
     }
 
@@ -137,7 +137,7 @@ double Parser::parseDouble(const std::string &text, int line, int col)
         // Hex и decimal — std::stod обрабатывает оба
         return std::stod(clean);
     } catch (const std::exception &) {
-        throw std::runtime_error("Invalid number literal '" + text + "' at line "
+        throw std::runtime_error("Invalid number literal '" + std::string(text) + "' at line "
                                  + std::to_string(line) + " col " + std::to_string(col));
     }
 }
@@ -281,7 +281,7 @@ ASTNodePtr Parser::tryMultiAssign()
 
     // Первый элемент: идентификатор или ~
     if (check(TokenType::IDENTIFIER)) {
-        names.push_back(current().value);
+        names.emplace_back(current().value);
         pos_++;
     } else if (check(TokenType::TILDE)) {
         names.push_back("~");
@@ -294,7 +294,7 @@ ASTNodePtr Parser::tryMultiAssign()
     while (check(TokenType::COMMA)) {
         pos_++;
         if (check(TokenType::IDENTIFIER)) {
-            names.push_back(current().value);
+            names.emplace_back(current().value);
             pos_++;
         } else if (check(TokenType::TILDE)) {
             names.push_back("~");
@@ -447,7 +447,7 @@ ASTNodePtr Parser::parseGlobalPersistent()
     pos_++;
 
     while (check(TokenType::IDENTIFIER)) {
-        node->paramNames.push_back(current().value);
+        node->paramNames.emplace_back(current().value);
         pos_++;
     }
 
@@ -493,12 +493,12 @@ ASTNodePtr Parser::parseFunctionDef()
     if (hasOutput) {
         if (check(TokenType::LBRACKET)) {
             pos_++;
-            node->returnNames.push_back(consume(TokenType::IDENTIFIER, "return var").value);
+            node->returnNames.emplace_back(consume(TokenType::IDENTIFIER, "return var").value);
             while (match(TokenType::COMMA))
-                node->returnNames.push_back(consume(TokenType::IDENTIFIER, "return var").value);
+                node->returnNames.emplace_back(consume(TokenType::IDENTIFIER, "return var").value);
             consume(TokenType::RBRACKET, "]");
         } else {
-            node->returnNames.push_back(consume(TokenType::IDENTIFIER, "return var").value);
+            node->returnNames.emplace_back(consume(TokenType::IDENTIFIER, "return var").value);
         }
         consume(TokenType::ASSIGN, "=");
     }
@@ -507,9 +507,9 @@ ASTNodePtr Parser::parseFunctionDef()
 
     if (match(TokenType::LPAREN)) {
         if (!check(TokenType::RPAREN)) {
-            node->paramNames.push_back(consume(TokenType::IDENTIFIER, "param").value);
+            node->paramNames.emplace_back(consume(TokenType::IDENTIFIER, "param").value);
             while (match(TokenType::COMMA))
-                node->paramNames.push_back(consume(TokenType::IDENTIFIER, "param").value);
+                node->paramNames.emplace_back(consume(TokenType::IDENTIFIER, "param").value);
         }
         consume(TokenType::RPAREN, ")");
     }
@@ -571,7 +571,7 @@ ASTNodePtr Parser::parseShortCircuitOr()
     auto left = parseShortCircuitAnd();
     while (check(TokenType::OR_SHORT)) {
         auto [ln, cl] = loc();
-        std::string op = current().value;
+        std::string op(current().value);
         pos_++;
         auto n = makeNode(NodeType::BINARY_OP, ln, cl);
         n->strValue = std::move(op);
@@ -588,7 +588,7 @@ ASTNodePtr Parser::parseShortCircuitAnd()
     auto left = parseElementOr();
     while (check(TokenType::AND_SHORT)) {
         auto [ln, cl] = loc();
-        std::string op = current().value;
+        std::string op(current().value);
         pos_++;
         auto n = makeNode(NodeType::BINARY_OP, ln, cl);
         n->strValue = std::move(op);
@@ -605,7 +605,7 @@ ASTNodePtr Parser::parseElementOr()
     auto left = parseElementAnd();
     while (check(TokenType::OR)) {
         auto [ln, cl] = loc();
-        std::string op = current().value;
+        std::string op(current().value);
         pos_++;
         auto n = makeNode(NodeType::BINARY_OP, ln, cl);
         n->strValue = std::move(op);
@@ -622,7 +622,7 @@ ASTNodePtr Parser::parseElementAnd()
     auto left = parseComparison();
     while (check(TokenType::AND)) {
         auto [ln, cl] = loc();
-        std::string op = current().value;
+        std::string op(current().value);
         pos_++;
         auto n = makeNode(NodeType::BINARY_OP, ln, cl);
         n->strValue = std::move(op);
@@ -639,7 +639,7 @@ ASTNodePtr Parser::parseComparison()
     while (check(TokenType::EQ) || check(TokenType::NEQ) || check(TokenType::LT)
            || check(TokenType::GT) || check(TokenType::LEQ) || check(TokenType::GEQ)) {
         auto [ln, cl] = loc();
-        std::string op = current().value;
+        std::string op(current().value);
         pos_++;
         auto n = makeNode(NodeType::BINARY_OP, ln, cl);
         n->strValue = std::move(op);
@@ -678,7 +678,7 @@ ASTNodePtr Parser::parseAddSub()
     auto left = parseMulDiv();
     while (check(TokenType::PLUS) || check(TokenType::MINUS)) {
         auto [ln, cl] = loc();
-        std::string op = current().value;
+        std::string op(current().value);
         pos_++;
         auto n = makeNode(NodeType::BINARY_OP, ln, cl);
         n->strValue = std::move(op);
@@ -696,7 +696,7 @@ ASTNodePtr Parser::parseMulDiv()
            || check(TokenType::DOT_BACKSLASH) || check(TokenType::DOT_STAR)
            || check(TokenType::DOT_SLASH)) {
         auto [ln, cl] = loc();
-        std::string op = current().value;
+        std::string op(current().value);
         pos_++;
         auto n = makeNode(NodeType::BINARY_OP, ln, cl);
         n->strValue = std::move(op);
@@ -742,7 +742,7 @@ ASTNodePtr Parser::parsePower()
     auto left = parsePostfix();
     if (check(TokenType::CARET) || check(TokenType::DOT_CARET)) {
         auto [ln, cl] = loc();
-        std::string op = current().value;
+        std::string op(current().value);
         pos_++;
         auto n = makeNode(NodeType::BINARY_OP, ln, cl);
         n->strValue = std::move(op);
@@ -878,7 +878,7 @@ ASTNodePtr Parser::parsePrimary()
         return makeNode(NodeType::COLON_EXPR, ln, cl);
     }
     default:
-        throw std::runtime_error("Unexpected token '" + current().value + "' at line "
+        throw std::runtime_error("Unexpected token '" + std::string(current().value) + "' at line "
                                  + std::to_string(ln) + " col " + std::to_string(cl));
     }
 }
@@ -904,9 +904,9 @@ ASTNodePtr Parser::parseAnonFunc()
     auto n = makeNode(NodeType::ANON_FUNC, ln, cl);
     consume(TokenType::LPAREN, "(");
     if (!check(TokenType::RPAREN)) {
-        n->paramNames.push_back(consume(TokenType::IDENTIFIER, "param").value);
+        n->paramNames.emplace_back(consume(TokenType::IDENTIFIER, "param").value);
         while (match(TokenType::COMMA))
-            n->paramNames.push_back(consume(TokenType::IDENTIFIER, "param").value);
+            n->paramNames.emplace_back(consume(TokenType::IDENTIFIER, "param").value);
     }
     consume(TokenType::RPAREN, ")");
     n->children.push_back(parseExpression());
@@ -0,0 +1,156 @@
+// src/MLabResolver.cpp
+#include "MLabResolver.hpp"
+#include "MLabValue.hpp"
+
+#include <algorithm>
+
+namespace mlab {
+
+// ============================================================
+// Helpers
+// ============================================================
+static bool contains(const std::vector<std::string> &v, const std::string &name)
+{
+    return std::find(v.begin(), v.end(), name) != v.end();
+}
+
+static void addUnique(std::vector<std::string> &v, const std::string &name)
+{
+    if (!contains(v, name))
+        v.push_back(name);
+}
+
+// ============================================================
+// Local-name collection
+// ============================================================
+void SlotResolver::collectLocals(const ASTNode *node,
+                                 std::vector<std::string> &locals,
+                                 std::vector<std::string> &excluded)
+{
+    if (!node)
+        return;
+
+    switch (node->type) {
+    case NodeType::FUNCTION_DEF:
+    case NodeType::ANON_FUNC:
+        // Nested scopes are resolved on their own.
+        return;
+    case NodeType::GLOBAL_STMT:
+    case NodeType::PERSISTENT_STMT:
+        for (auto &name : node->paramNames)
+            addUnique(excluded, name);
+        return;
+    case NodeType::ASSIGN:
+        if (node->children[0]->type == NodeType::IDENTIFIER)
+            addUnique(locals, node->children[0]->strValue);
+        break;
+    case NodeType::MULTI_ASSIGN:
+        for (auto &name : node->returnNames)
+            if (name != "~")
+                addUnique(locals, name);
+        break;
+    case NodeType::FOR_STMT:
+        addUnique(locals, node->strValue);
+        break;
+    default:
+        break;
+    }
+
+    for (auto &child : node->children)
+        collectLocals(child.get(), locals, excluded);
+    for (auto &[cond, body] : node->branches) {
+        collectLocals(cond.get(), locals, excluded);
+        collectLocals(body.get(), locals, excluded);
+    }
+    collectLocals(node->elseBranch.get(), locals, excluded);
+}
+
+// ============================================================
+// Identifier collection (free-variable analysis)
+// ============================================================
+void SlotResolver::collectIdentifiers(const ASTNode *node, std::vector<std::string> &names)
+{
+    if (!node)
+        return;
+    if (node->type == NodeType::IDENTIFIER)
+        addUnique(names, node->strValue);
+    else if (node->type == NodeType::FOR_STMT)
+        addUnique(names, node->strValue);
+
+    for (auto &child : node->children)
+        collectIdentifiers(child.get(), names);
+    for (auto &[cond, body] : node->branches) {
+        collectIdentifiers(cond.get(), names);
+        collectIdentifiers(body.get(), names);
+    }
+    collectIdentifiers(node->elseBranch.get(), names);
+}
+
+// ============================================================
+// Slot application
+// ============================================================
+void SlotResolver::apply(ASTNode *node,
+                         const GlobalSlotFn &slotFor,
+                         const GlobalSlotFn *builtinFor)
+{
+    if (!node)
+        return;
+
+    if (node->type == NodeType::FUNCTION_DEF || node->type == NodeType::ANON_FUNC)
+        return;
+
+    if (node->type == NodeType::IDENTIFIER)
+        node->slot = slotFor(node->strValue);
+    else if (node->type == NodeType::FOR_STMT)
+        node->slot = slotFor(node->strValue); // loop variable
+    else if (node->type == NodeType::FIELD_ACCESS)
+        node->fieldId = static_cast<int>(internFieldName(node->strValue));
+    else if (node->type == NodeType::CALL && builtinFor && !node->children.empty()
+             && node->children[0]->type == NodeType::IDENTIFIER)
+        node->builtinId = (*builtinFor)(node->children[0]->strValue);
+
+    for (auto &child : node->children)
+        apply(child.get(), slotFor, builtinFor);
+    for (auto &[cond, body] : node->branches) {
+        apply(cond.get(), slotFor, builtinFor);
+        apply(body.get(), slotFor, builtinFor);
+    }
+    apply(node->elseBranch.get(), slotFor, builtinFor);
+}
+
+// ============================================================
+// Entry points
+// ============================================================
+void SlotResolver::resolveGlobal(ASTNode *root,
+                                 const GlobalSlotFn &slotFor,
+                                 const GlobalSlotFn *builtinFor)
+{
+    apply(root, slotFor, builtinFor);
+}
+
+int SlotResolver::resolveFunction(ASTNode *body,
+                                  const std::vector<std::string> &params,
+                                  const GlobalSlotFn *builtinFor)
+{
+    std::vector<std::string> locals;
+    std::vector<std::string> excluded;
+    for (auto &p : params)
+        addUnique(locals, p);
+    collectLocals(body, locals, excluded);
+
+    for (auto &name : excluded)
+        locals.erase(std::remove(locals.begin(), locals.end(), name), locals.end());
+
+    apply(
+        body,
+        [&locals](const std::string &name) -> int {
+            for (size_t i = 0; i < locals.size(); ++i)
+                if (locals[i] == name)
+                    return static_cast<int>(i);
+            return -1;
+        },
+        builtinFor);
+    return static_cast<int>(locals.size());
+}
+
+} // namespace mlab
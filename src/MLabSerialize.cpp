@@ -0,0 +1,189 @@
+// src/MLabSerialize.cpp
+#include "MLabSerialize.hpp"
+
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+
+namespace mlab {
+namespace serialize {
+
+static const char kMagic[8] = {'M', 'L', 'A', 'B', 'W', 'S', '1', '\0'};
+
+// ============================================================
+// Primitives
+// ============================================================
+template<typename T>
+static void writePod(std::ostream &os, T v)
+{
+    os.write(reinterpret_cast<const char *>(&v), sizeof(T));
+}
+
+template<typename T>
+static T readPod(std::istream &is)
+{
+    T v;
+    is.read(reinterpret_cast<char *>(&v), sizeof(T));
+    if (!is)
+        throw std::runtime_error("Workspace file truncated");
+    return v;
+}
+
+static void padTo8(std::ostream &os)
+{
+    static const char zeros[8] = {0};
+    auto pos = os.tellp();
+    size_t rem = static_cast<size_t>(pos) % 8;
+    if (rem)
+        os.write(zeros, 8 - rem);
+}
+
+static void skipTo8(std::istream &is)
+{
+    auto pos = is.tellg();
+    size_t rem = static_cast<size_t>(pos) % 8;
+    if (rem)
+        is.ignore(static_cast<std::streamsize>(8 - rem));
+}
+
+void writeName(std::ostream &os, const std::string &name)
+{
+    writePod<uint32_t>(os, static_cast<uint32_t>(name.size()));
+    os.write(name.data(), static_cast<std::streamsize>(name.size()));
+}
+
+std::string readName(std::istream &is)
+{
+    uint32_t len = readPod<uint32_t>(is);
+    std::string name(len, '\0');
+    is.read(&name[0], len);
+    if (!is)
+        throw std::runtime_error("Workspace file truncated");
+    return name;
+}
+
+void writeHeader(std::ostream &os, size_t varCount)
+{
+    os.write(kMagic, sizeof(kMagic));
+    writePod<uint64_t>(os, static_cast<uint64_t>(varCount));
+}
+
+size_t readHeader(std::istream &is)
+{
+    char magic[8];
+    is.read(magic, sizeof(magic));
+    if (!is || std::memcmp(magic, kMagic, sizeof(kMagic)) != 0)
+        throw std::runtime_error("Not an MLab workspace file");
+    return static_cast<size_t>(readPod<uint64_t>(is));
+}
+
+// ============================================================
+// Values
+// ============================================================
+void writeValue(std::ostream &os, const MValue &val)
+{
+    writePod<uint8_t>(os, static_cast<uint8_t>(val.type()));
+    const Dims &d = val.dims();
+    writePod<uint8_t>(os, static_cast<uint8_t>(d.ndims()));
+    writePod<uint64_t>(os, d.rows());
+    writePod<uint64_t>(os, d.cols());
+    writePod<uint64_t>(os, d.pages());
+
+    switch (val.type()) {
+    case MType::EMPTY:
+        return;
+    case MType::CELL: {
+        for (size_t i = 0; i < val.numel(); ++i)
+            writeValue(os, val.cellAt(i));
+        return;
+    }
+    case MType::STRUCT: {
+        writePod<uint32_t>(os, static_cast<uint32_t>(val.fieldCount()));
+        for (size_t i = 0; i < val.fieldCount(); ++i) {
+            writeName(os, val.fieldNameAt(i));
+            writeValue(os, val.fieldAt(i));
+        }
+        return;
+    }
+    case MType::FUNC_HANDLE:
+        writeName(os, val.funcHandleName());
+        return;
+    case MType::STRING: {
+        writePod<uint64_t>(os, val.numel());
+        for (size_t i = 0; i < val.numel(); ++i) {
+            auto sv = val.stringAt(i);
+            writePod<uint32_t>(os, static_cast<uint32_t>(sv.size()));
+            os.write(sv.data(), static_cast<std::streamsize>(sv.size()));
+        }
+        return;
+    }
+    default: {
+        // Numeric / logical / char payload: aligned raw column-major
+        // bytes so a mapping loader can reference them in place.
+        uint64_t bytes = val.rawBytes(); // materializes lazy ranges
+        writePod<uint64_t>(os, bytes);
+        padTo8(os);
+        if (bytes > 0)
+            os.write(static_cast<const char *>(val.rawData()),
+                     static_cast<std::streamsize>(bytes));
+        return;
+    }
+    }
+}
+
+MValue readValue(std::istream &is, Allocator *alloc)
+{
+    MType type = static_cast<MType>(readPod<uint8_t>(is));
+    uint8_t nd = readPod<uint8_t>(is);
+    uint64_t rows = readPod<uint64_t>(is);
+    uint64_t cols = readPod<uint64_t>(is);
+    uint64_t pages = readPod<uint64_t>(is);
+
+    switch (type) {
+    case MType::EMPTY:
+        return MValue::empty();
+    case MType::CELL: {
+        auto c = MValue::cell(rows, cols);
+        for (size_t i = 0; i < c.numel(); ++i)
+            c.cellAt(i) = readValue(is, alloc);
+        return c;
+    }
+    case MType::STRUCT: {
+        auto s = MValue::structure();
+        uint32_t nfields = readPod<uint32_t>(is);
+        for (uint32_t i = 0; i < nfields; ++i) {
+            std::string name = readName(is);
+            s.field(name) = readValue(is, alloc);
+        }
+        return s;
+    }
+    case MType::FUNC_HANDLE:
+        return MValue::funcHandle(readName(is), alloc);
+    case MType::STRING: {
+        uint64_t count = readPod<uint64_t>(is);
+        std::vector<std::string> items;
+        items.reserve(count);
+        for (uint64_t i = 0; i < count; ++i)
+            items.push_back(readName(is));
+        return MValue::stringArray(std::move(items));
+    }
+    default: {
+        uint64_t bytes = readPod<uint64_t>(is);
+        skipTo8(is);
+        MValue m = (nd == 3) ? MValue::matrix3d(rows, cols, pages, type, alloc)
+                             : MValue::matrix(rows, cols, type, alloc);
+        if (bytes != m.rawBytes())
+            throw std::runtime_error("Workspace payload size mismatch");
+        if (bytes > 0) {
+            is.read(static_cast<char *>(m.rawDataMut()), static_cast<std::streamsize>(bytes));
+            if (!is)
+                throw std::runtime_error("Workspace file truncated");
+        }
+        return m;
+    }
+    }
+}
+
+} // namespace serialize
+} // namespace mlab
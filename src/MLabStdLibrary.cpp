@@ -1,11 +1,15 @@
 #include "MLabStdLibrary.hpp"
+#include "MLabKernels.hpp"
+#include "MLabThreadPool.hpp"
 
 #include <algorithm>
 #include <cmath>
 #include <cstring>
 #include <iostream>
+#include <limits>
 #include <numeric>
 #include <random>
+#include <type_traits>
 #include <sstream>
 #include <stdexcept>
 
@@ -54,6 +58,76 @@ static MValue elementwiseDouble(const MValue &a, const MValue &b, Op op, Allocat
     return r;
 }
 
+// ============================================================
+// Helper: SIMD-dispatched elementwise op on double arrays
+// (broadcast cases specialized; see MLabKernels.cpp)
+// ============================================================
+static double applyScalar(kernels::BinOp op, double a, double b)
+{
+    switch (op) {
+    case kernels::BinOp::ADD:
+        return a + b;
+    case kernels::BinOp::SUB:
+        return a - b;
+    case kernels::BinOp::MUL:
+        return a * b;
+    case kernels::BinOp::DIV:
+        return a / b;
+    case kernels::BinOp::POW:
+        return std::pow(a, b);
+    }
+    return 0;
+}
+
+// A uniquely-owned, non-range operand (an expression temporary) can be
+// overwritten instead of allocating a result buffer. The operands arrive
+// as const refs through BinaryOpFunc, but refcount 1 proves nobody else
+// observes the buffer, so the cast is sound.
+static MValue *inPlaceCandidate(const MValue &v)
+{
+    if (v.type() == MType::DOUBLE && !v.isScalar() && !v.isRange() && v.bufferRefCount() == 1)
+        return const_cast<MValue *>(&v);
+    return nullptr;
+}
+
+static MValue fastBinaryDouble(kernels::BinOp op, const MValue &a, const MValue &b, Allocator *alloc)
+{
+    if (a.isScalar() && b.isScalar())
+        return MValue::scalar(applyScalar(op, a.toScalar(), b.toScalar()), alloc);
+    if (a.isScalar()) {
+        if (MValue *dst = inPlaceCandidate(b)) {
+            kernels::binaryDoubleScalarLeft(op, a.toScalar(), dst->doubleData(),
+                                            dst->doubleDataMut(), dst->numel());
+            return *dst;
+        }
+        auto r = MValue::matrix(b.dims().rows(), b.dims().cols(), MType::DOUBLE, alloc);
+        kernels::binaryDoubleScalarLeft(op, a.toScalar(), b.doubleData(), r.doubleDataMut(),
+                                        b.numel());
+        return r;
+    }
+    if (b.isScalar()) {
+        if (MValue *dst = inPlaceCandidate(a)) {
+            kernels::binaryDoubleScalarRight(op, dst->doubleData(), b.toScalar(),
+                                             dst->doubleDataMut(), dst->numel());
+            return *dst;
+        }
+        auto r = MValue::matrix(a.dims().rows(), a.dims().cols(), MType::DOUBLE, alloc);
+        kernels::binaryDoubleScalarRight(op, a.doubleData(), b.toScalar(), r.doubleDataMut(),
+                                         a.numel());
+        return r;
+    }
+    if (a.dims() != b.dims())
+        throw std::runtime_error("Matrix dimensions must agree");
+    if (MValue *dst = inPlaceCandidate(a)) {
+        kernels::binaryDouble(op, dst->doubleData(), b.doubleData(), dst->doubleDataMut(),
+                              dst->numel());
+        return *dst;
+    }
+    auto r = MValue::matrix(a.dims().rows(), a.dims().cols(), MType::DOUBLE, alloc);
+    kernels::binaryDouble(op, a.doubleData(), b.doubleData(), r.doubleDataMut(), a.numel());
+    return r;
+}
+
 // ============================================================
 // Helper: elementwise binary op on complex arrays
 // ============================================================
@@ -113,6 +187,231 @@ static MValue unaryComplex(const MValue &a, Op op, Allocator *alloc)
     return r;
 }
 
+// ============================================================
+// Integer kernels — type-preserving, MATLAB saturation semantics,
+// templated over element width so the compiler specializes each type
+// ============================================================
+template<typename T>
+static T satCast(double v)
+{
+    if (std::isnan(v))
+        return 0;
+    double r = std::round(v);
+    if (r <= static_cast<double>(std::numeric_limits<T>::min()))
+        return std::numeric_limits<T>::min();
+    if (r >= static_cast<double>(std::numeric_limits<T>::max()))
+        return std::numeric_limits<T>::max();
+    return static_cast<T>(r);
+}
+
+template<typename T>
+static T satAdd(T a, T b)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    T r;
+    if (!__builtin_add_overflow(a, b, &r))
+        return r;
+    if (std::is_unsigned<T>::value || b > 0)
+        return std::numeric_limits<T>::max();
+    return std::numeric_limits<T>::min();
+#else
+    return satCast<T>(static_cast<double>(a) + static_cast<double>(b));
+#endif
+}
+
+template<typename T>
+static T satSub(T a, T b)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    T r;
+    if (!__builtin_sub_overflow(a, b, &r))
+        return r;
+    if (std::is_unsigned<T>::value)
+        return 0;
+    return b > 0 ? std::numeric_limits<T>::min() : std::numeric_limits<T>::max();
+#else
+    return satCast<T>(static_cast<double>(a) - static_cast<double>(b));
+#endif
+}
+
+template<typename T>
+static T satMul(T a, T b)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    T r;
+    if (!__builtin_mul_overflow(a, b, &r))
+        return r;
+    bool negative = !std::is_unsigned<T>::value && ((a < 0) != (b < 0));
+    return negative ? std::numeric_limits<T>::min() : std::numeric_limits<T>::max();
+#else
+    return satCast<T>(static_cast<double>(a) * static_cast<double>(b));
+#endif
+}
+
+// Calls fn with a value of the matching element type as a tag.
+template<typename Fn>
+static MValue intDispatch(MType t, Fn &&fn)
+{
+    switch (t) {
+    case MType::INT8:
+        return fn(int8_t{});
+    case MType::INT16:
+        return fn(int16_t{});
+    case MType::INT32:
+        return fn(int32_t{});
+    case MType::INT64:
+        return fn(int64_t{});
+    case MType::UINT8:
+        return fn(uint8_t{});
+    case MType::UINT16:
+        return fn(uint16_t{});
+    case MType::UINT32:
+        return fn(uint32_t{});
+    case MType::UINT64:
+        return fn(uint64_t{});
+    default:
+        throw std::runtime_error("Not an integer type");
+    }
+}
+
+template<typename T>
+static MValue intFromDouble(const MValue &a, MType t, Allocator *alloc)
+{
+    auto r = MValue::matrix(a.dims().rows(), a.dims().cols(), t, alloc);
+    T *dst = static_cast<T *>(r.rawDataMut());
+    if (a.type() == MType::DOUBLE) {
+        for (size_t i = 0; i < a.numel(); ++i)
+            dst[i] = satCast<T>(a(i));
+    } else if (a.isLogical()) {
+        const uint8_t *src = a.logicalData();
+        for (size_t i = 0; i < a.numel(); ++i)
+            dst[i] = static_cast<T>(src[i]);
+    } else if (a.type() == t) {
+        std::memcpy(dst, a.rawData(), a.numel() * sizeof(T));
+    } else if (isIntegerType(a.type())) {
+        for (size_t i = 0; i < a.numel(); ++i)
+            dst[i] = satCast<T>(a.toScalar()); // scalar cross-width only
+    } else {
+        throw std::runtime_error("Cannot convert " + std::string(mtypeName(a.type()))
+                                 + " to integer");
+    }
+    return r;
+}
+
+// a op b where both are the same integer type (arrays or scalars), or
+// one side is a double scalar (computed in double, saturated back).
+static MValue intBinary(kernels::BinOp op, const MValue &a, const MValue &b, Allocator *alloc)
+{
+    MType t = isIntegerType(a.type()) ? a.type() : b.type();
+
+    return intDispatch(t, [&](auto tag) -> MValue {
+        using T = decltype(tag);
+
+        auto applySat = [op](T x, T y) -> T {
+            switch (op) {
+            case kernels::BinOp::ADD:
+                return satAdd<T>(x, y);
+            case kernels::BinOp::SUB:
+                return satSub<T>(x, y);
+            case kernels::BinOp::MUL:
+                return satMul<T>(x, y);
+            default: // DIV / POW round through double
+                return satCast<T>(applyScalar(op,
+                                              static_cast<double>(x),
+                                              static_cast<double>(y)));
+            }
+        };
+
+        // Mixed with a double operand: compute in double, saturate back.
+        if (a.type() == MType::DOUBLE || b.type() == MType::DOUBLE) {
+            const MValue &iv = isIntegerType(a.type()) ? a : b;
+            const MValue &dv = isIntegerType(a.type()) ? b : a;
+            if (!dv.isScalar() && !iv.isScalar() && dv.dims() != iv.dims())
+                throw std::runtime_error("Matrix dimensions must agree");
+            size_t n = std::max(iv.numel(), dv.numel());
+            const Dims &shape = iv.isScalar() ? dv.dims() : iv.dims();
+            auto r = MValue::matrix(shape.rows(), shape.cols(), t, alloc);
+            T *dst = static_cast<T *>(r.rawDataMut());
+            const T *ip = static_cast<const T *>(iv.rawData());
+            for (size_t i = 0; i < n; ++i) {
+                double x = static_cast<double>(ip[iv.isScalar() ? 0 : i]);
+                double y = dv.isScalar() ? dv.toScalar() : dv(i);
+                double res = (&iv == &a) ? applyScalar(op, x, y) : applyScalar(op, y, x);
+                dst[i] = satCast<T>(res);
+            }
+            return r;
+        }
+
+        if (a.type() != b.type())
+            throw std::runtime_error("Integer operands must have the same class");
+        if (!a.isScalar() && !b.isScalar() && a.dims() != b.dims())
+            throw std::runtime_error("Matrix dimensions must agree");
+
+        const Dims &shape = a.isScalar() ? b.dims() : a.dims();
+        size_t n = std::max(a.numel(), b.numel());
+        auto r = MValue::matrix(shape.rows(), shape.cols(), t, alloc);
+        T *dst = static_cast<T *>(r.rawDataMut());
+        const T *pa = static_cast<const T *>(a.rawData());
+        const T *pb = static_cast<const T *>(b.rawData());
+        for (size_t i = 0; i < n; ++i)
+            dst[i] = applySat(pa[a.isScalar() ? 0 : i], pb[b.isScalar() ? 0 : i]);
+        return r;
+    });
+}
+
+static MValue intCompare(kernels::CmpOp op, const MValue &a, const MValue &b, Allocator *alloc)
+{
+    const MValue &iv = isIntegerType(a.type()) ? a : b;
+    // Same rule as intBinary: the elem reader below casts through the
+    // first integer operand's element type, so mixing integer classes
+    // would misread the other buffer.
+    if (isIntegerType(a.type()) && isIntegerType(b.type()) && a.type() != b.type())
+        throw std::runtime_error("Integer operands must have the same class");
+    if (!a.isScalar() && !b.isScalar() && a.dims() != b.dims())
+        throw std::runtime_error("Matrix dimensions must agree for comparison");
+    const Dims &shape = a.isScalar() ? b.dims() : a.dims();
+    size_t n = std::max(a.numel(), b.numel());
+    auto r = MValue::matrix(shape.rows(), shape.cols(), MType::LOGICAL, alloc);
+    uint8_t *dst = r.logicalDataMut();
+
+    intDispatch(iv.type(), [&](auto tag) -> MValue {
+        using T = decltype(tag);
+        auto elem = [&](const MValue &v, size_t i) -> double {
+            if (v.type() == MType::DOUBLE)
+                return v.isScalar() ? v.toScalar() : v(i);
+            const T *p = static_cast<const T *>(v.rawData());
+            return static_cast<double>(p[v.isScalar() ? 0 : i]);
+        };
+        for (size_t i = 0; i < n; ++i) {
+            double x = elem(a, i), y = elem(b, i);
+            bool hit;
+            switch (op) {
+            case kernels::CmpOp::EQ:
+                hit = x == y;
+                break;
+            case kernels::CmpOp::NE:
+                hit = x != y;
+                break;
+            case kernels::CmpOp::LT:
+                hit = x < y;
+                break;
+            case kernels::CmpOp::GT:
+                hit = x > y;
+                break;
+            case kernels::CmpOp::LE:
+                hit = x <= y;
+                break;
+            default:
+                hit = x >= y;
+                break;
+            }
+            dst[i] = hit ? 1 : 0;
+        }
+        return MValue::empty();
+    });
+    return r;
+}
+
 // ============================================================
 // Install all
 // ============================================================
@@ -125,6 +424,8 @@ void StdLibrary::install(Engine &engine)
     registerIOFunctions(engine);
     registerTypeFunctions(engine);
     registerCellStructFunctions(engine);
+    registerFunctionalFunctions(engine);
+    registerIntegerFunctions(engine);
     registerStringFunctions(engine);
     registerComplexFunctions(engine);
 }
@@ -140,7 +441,9 @@ void StdLibrary::registerBinaryOps(Engine &engine)
         if (a.isComplex() || b.isComplex())
             return elementwiseComplex(a, b, std::plus<Complex>{}, alloc);
         if (a.type() == MType::DOUBLE && b.type() == MType::DOUBLE)
-            return elementwiseDouble(a, b, std::plus<double>{}, alloc);
+            return fastBinaryDouble(kernels::BinOp::ADD, a, b, alloc);
+        if (isIntegerType(a.type()) || isIntegerType(b.type()))
+            return intBinary(kernels::BinOp::ADD, a, b, alloc);
         if (a.isChar() && b.isChar())
             return MValue::fromString(a.toString() + b.toString(), alloc);
         throw std::runtime_error("Unsupported types for +");
@@ -152,7 +455,9 @@ void StdLibrary::registerBinaryOps(Engine &engine)
         if (a.isComplex() || b.isComplex())
             return elementwiseComplex(a, b, std::minus<Complex>{}, alloc);
         if (a.type() == MType::DOUBLE && b.type() == MType::DOUBLE)
-            return elementwiseDouble(a, b, std::minus<double>{}, alloc);
+            return fastBinaryDouble(kernels::BinOp::SUB, a, b, alloc);
+        if (isIntegerType(a.type()) || isIntegerType(b.type()))
+            return intBinary(kernels::BinOp::SUB, a, b, alloc);
         throw std::runtime_error("Unsupported types for -");
     });
 
@@ -162,7 +467,9 @@ void StdLibrary::registerBinaryOps(Engine &engine)
         if (a.isComplex() || b.isComplex())
             return elementwiseComplex(a, b, std::multiplies<Complex>{}, alloc);
         if (a.type() == MType::DOUBLE && b.type() == MType::DOUBLE)
-            return elementwiseDouble(a, b, std::multiplies<double>{}, alloc);
+            return fastBinaryDouble(kernels::BinOp::MUL, a, b, alloc);
+        if (isIntegerType(a.type()) || isIntegerType(b.type()))
+            return intBinary(kernels::BinOp::MUL, a, b, alloc);
         throw std::runtime_error("Unsupported types for .*");
     });
 
@@ -179,31 +486,23 @@ void StdLibrary::registerBinaryOps(Engine &engine)
             if (K != cb.dims().rows())
                 throw std::runtime_error("Inner matrix dimensions must agree");
             auto r = MValue::complexMatrix(M, N, alloc);
-            for (size_t i = 0; i < M; ++i)
-                for (size_t j = 0; j < N; ++j) {
-                    Complex s(0, 0);
-                    for (size_t k = 0; k < K; ++k)
-                        s += ca.complexElem(i, k) * cb.complexElem(k, j);
-                    r.complexDataMut()[j * M + i] = s;
-                }
+            kernels::matmulComplex(ca.complexData(), cb.complexData(), r.complexDataMut(), M, K, N);
             return r;
         }
 
+        if ((isIntegerType(a.type()) || isIntegerType(b.type()))
+            && (a.isScalar() || b.isScalar()))
+            return intBinary(kernels::BinOp::MUL, a, b, alloc);
+
         // Double matrix multiply
         if (a.isScalar() || b.isScalar())
-            return elementwiseDouble(a, b, std::multiplies<double>{}, alloc);
+            return fastBinaryDouble(kernels::BinOp::MUL, a, b, alloc);
         if (a.type() == MType::DOUBLE && b.type() == MType::DOUBLE) {
             size_t M = a.dims().rows(), K = a.dims().cols(), N = b.dims().cols();
             if (K != b.dims().rows())
                 throw std::runtime_error("Inner matrix dimensions must agree");
             auto r = MValue::matrix(M, N, MType::DOUBLE, alloc);
-            for (size_t i = 0; i < M; ++i)
-                for (size_t j = 0; j < N; ++j) {
-                    double s = 0;
-                    for (size_t k = 0; k < K; ++k)
-                        s += a(i, k) * b(k, j);
-                    r.elem(i, j) = s;
-                }
+            kernels::matmulDouble(a.doubleData(), b.doubleData(), r.doubleDataMut(), M, K, N);
             return r;
         }
         throw std::runtime_error("Unsupported types for *");
@@ -215,7 +514,7 @@ void StdLibrary::registerBinaryOps(Engine &engine)
         if (a.isComplex() || b.isComplex())
             return elementwiseComplex(a, b, std::divides<Complex>{}, alloc);
         if (a.type() == MType::DOUBLE && b.isScalar())
-            return elementwiseDouble(a, b, std::divides<double>{}, alloc);
+            return fastBinaryDouble(kernels::BinOp::DIV, a, b, alloc);
         if (a.isScalar() && b.isScalar())
             return MValue::scalar(a.toScalar() / b.toScalar(), alloc);
         throw std::runtime_error("Matrix right division not implemented");
@@ -227,7 +526,9 @@ void StdLibrary::registerBinaryOps(Engine &engine)
         if (a.isComplex() || b.isComplex())
             return elementwiseComplex(a, b, std::divides<Complex>{}, alloc);
         if (a.type() == MType::DOUBLE && b.type() == MType::DOUBLE)
-            return elementwiseDouble(a, b, std::divides<double>{}, alloc);
+            return fastBinaryDouble(kernels::BinOp::DIV, a, b, alloc);
+        if (isIntegerType(a.type()) || isIntegerType(b.type()))
+            return intBinary(kernels::BinOp::DIV, a, b, alloc);
         throw std::runtime_error("Unsupported types for ./");
     });
 
@@ -251,7 +552,7 @@ void StdLibrary::registerBinaryOps(Engine &engine)
                 a, b, [](const Complex &x, const Complex &y) { return std::pow(x, y); }, alloc);
         }
         if (a.type() == MType::DOUBLE && b.type() == MType::DOUBLE) {
-            return elementwiseDouble(a, b, [](double x, double y) { return std::pow(x, y); }, alloc);
+            return fastBinaryDouble(kernels::BinOp::POW, a, b, alloc);
         }
         throw std::runtime_error("Unsupported types for .^");
     });
@@ -266,23 +567,21 @@ void StdLibrary::registerBinaryOps(Engine &engine)
 
     // --- Comparisons ---
     auto makeCmpOp = [](const std::string &op) -> BinaryOpFunc {
-        return [op](const MValue &a, const MValue &b) -> MValue {
-            auto cmp = [&](double x, double y) -> bool {
-                if (op == "==")
-                    return x == y;
-                if (op == "~=")
-                    return x != y;
-                if (op == "<")
-                    return x < y;
-                if (op == ">")
-                    return x > y;
-                if (op == "<=")
-                    return x <= y;
-                if (op == ">=")
-                    return x >= y;
-                return false;
-            };
-
+        kernels::CmpOp kop;
+        if (op == "==")
+            kop = kernels::CmpOp::EQ;
+        else if (op == "~=")
+            kop = kernels::CmpOp::NE;
+        else if (op == "<")
+            kop = kernels::CmpOp::LT;
+        else if (op == ">")
+            kop = kernels::CmpOp::GT;
+        else if (op == "<=")
+            kop = kernels::CmpOp::LE;
+        else
+            kop = kernels::CmpOp::GE;
+
+        return [op, kop](const MValue &a, const MValue &b) -> MValue {
             // String comparison for == and ~=
             if (a.isChar() && b.isChar()) {
                 if (op == "==")
@@ -291,36 +590,37 @@ void StdLibrary::registerBinaryOps(Engine &engine)
                     return MValue::logicalScalar(a.toString() != b.toString(), nullptr);
             }
 
-            if (a.isScalar() && b.isScalar())
-                return MValue::logicalScalar(cmp(a.toScalar(), b.toScalar()), nullptr);
+            if (a.isScalar() && b.isScalar()) {
+                uint8_t r;
+                double av = a.toScalar(), bv = b.toScalar();
+                kernels::compareDouble(kop, &av, &bv, &r, 1);
+                return MValue::logicalScalar(r != 0, nullptr);
+            }
+
+            if (isIntegerType(a.type()) || isIntegerType(b.type()))
+                return intCompare(kop, a, b, nullptr);
 
-            // Element-wise comparison for arrays
+            // Element-wise comparison for arrays (kernel per predicate)
             if (a.type() == MType::DOUBLE && b.type() == MType::DOUBLE) {
                 if (a.isScalar()) {
-                    auto r = MValue::matrix(b.dims().rows(),
-                                            b.dims().cols(),
-                                            MType::LOGICAL,
+                    auto r = MValue::matrix(b.dims().rows(), b.dims().cols(), MType::LOGICAL,
                                             nullptr);
-                    double av = a.toScalar();
-                    for (size_t i = 0; i < b.numel(); ++i)
-                        r.logicalDataMut()[i] = cmp(av, b.doubleData()[i]) ? 1 : 0;
+                    kernels::compareDoubleScalarLeft(kop, a.toScalar(), b.doubleData(),
+                                                     r.logicalDataMut(), b.numel());
                     return r;
                 }
                 if (b.isScalar()) {
-                    auto r = MValue::matrix(a.dims().rows(),
-                                            a.dims().cols(),
-                                            MType::LOGICAL,
+                    auto r = MValue::matrix(a.dims().rows(), a.dims().cols(), MType::LOGICAL,
                                             nullptr);
-                    double bv = b.toScalar();
-                    for (size_t i = 0; i < a.numel(); ++i)
-                        r.logicalDataMut()[i] = cmp(a.doubleData()[i], bv) ? 1 : 0;
+                    kernels::compareDoubleScalarRight(kop, a.doubleData(), b.toScalar(),
+                                                      r.logicalDataMut(), a.numel());
                     return r;
                 }
                 if (a.dims() != b.dims())
                     throw std::runtime_error("Matrix dimensions must agree for comparison");
                 auto r = MValue::matrix(a.dims().rows(), a.dims().cols(), MType::LOGICAL, nullptr);
-                for (size_t i = 0; i < a.numel(); ++i)
-                    r.logicalDataMut()[i] = cmp(a.doubleData()[i], b.doubleData()[i]) ? 1 : 0;
+                kernels::compareDouble(kop, a.doubleData(), b.doubleData(), r.logicalDataMut(),
+                                       a.numel());
                 return r;
             }
 
@@ -341,6 +641,12 @@ void StdLibrary::registerBinaryOps(Engine &engine)
         // scalar & scalar
         if (a.isScalar() && b.isScalar())
             return MValue::logicalScalar(a.toBool() && b.toBool(), alloc);
+        // logical masks: 64 elements per word op
+        if (a.isLogical() && b.isLogical() && a.numel() == b.numel()) {
+            auto r = MValue::matrix(a.dims().rows(), a.dims().cols(), MType::LOGICAL, alloc);
+            kernels::logicalAnd(a.logicalData(), b.logicalData(), r.logicalDataMut(), a.numel());
+            return r;
+        }
         // element-wise
         auto toBoolArray = [&](const MValue &v) -> std::vector<uint8_t> {
             std::vector<uint8_t> r(v.numel());
@@ -391,6 +697,11 @@ void StdLibrary::registerBinaryOps(Engine &engine)
         auto *alloc = &engine.allocator();
         if (a.isScalar() && b.isScalar())
             return MValue::logicalScalar(a.toBool() || b.toBool(), alloc);
+        if (a.isLogical() && b.isLogical() && a.numel() == b.numel()) {
+            auto r = MValue::matrix(a.dims().rows(), a.dims().cols(), MType::LOGICAL, alloc);
+            kernels::logicalOr(a.logicalData(), b.logicalData(), r.logicalDataMut(), a.numel());
+            return r;
+        }
         auto toBoolArray = [&](const MValue &v) -> std::vector<uint8_t> {
             std::vector<uint8_t> r(v.numel());
             if (v.isLogical()) {
@@ -458,10 +769,7 @@ void StdLibrary::registerUnaryOps(Engine &engine)
             if (a.isScalar())
                 return MValue::logicalScalar(!a.toBool(), alloc);
             auto r = MValue::matrix(a.dims().rows(), a.dims().cols(), MType::LOGICAL, alloc);
-            const uint8_t *src = a.logicalData();
-            uint8_t *dst = r.logicalDataMut();
-            for (size_t i = 0; i < a.numel(); ++i)
-                dst[i] = src[i] ? 0 : 1;
+            kernels::logicalNot(a.logicalData(), r.logicalDataMut(), a.numel());
             return r;
         }
         if (a.type() == MType::DOUBLE) {
@@ -533,151 +841,229 @@ void StdLibrary::registerUnaryOps(Engine &engine)
     });
 }
 
+// ============================================================
+// Helper: dim-aware reductions over double arrays
+// ============================================================
+enum class ReduceKind { SUM, PROD, MEAN, MIN, MAX };
+
+static double reduceContiguous(ReduceKind kind, const double *p, size_t n)
+{
+    size_t idx;
+    double v;
+    switch (kind) {
+    case ReduceKind::SUM:
+        return kernels::reduceSum(p, n);
+    case ReduceKind::PROD:
+        return kernels::reduceProd(p, n);
+    case ReduceKind::MEAN:
+        return kernels::reduceSum(p, n) / static_cast<double>(n);
+    case ReduceKind::MIN:
+        kernels::reduceMin(p, n, v, idx);
+        return v;
+    default:
+        kernels::reduceMax(p, n, v, idx);
+        return v;
+    }
+}
+
+static double reduceStrided(ReduceKind kind, const double *p, size_t n, size_t stride)
+{
+    switch (kind) {
+    case ReduceKind::SUM:
+        return kernels::reduceSumStrided(p, n, stride);
+    case ReduceKind::PROD:
+        return kernels::reduceProdStrided(p, n, stride);
+    case ReduceKind::MEAN:
+        return kernels::reduceSumStrided(p, n, stride) / static_cast<double>(n);
+    case ReduceKind::MIN:
+        return kernels::reduceMinStrided(p, n, stride);
+    default:
+        return kernels::reduceMaxStrided(p, n, stride);
+    }
+}
+
+// Reduces along `dim` (1 = rows, 2 = columns, 3 = pages) over the 2-D or
+// 3-D column-major array.
+static MValue reduceDouble(ReduceKind kind, const MValue &a, int dim, Allocator *alloc)
+{
+    const Dims &d = a.dims();
+    const double *p = a.doubleData();
+    size_t R = d.rows(), C = d.cols(), P = d.pages();
+    size_t pageStride = R * C;
+
+    if (dim == 1) {
+        auto r = d.is3D() ? MValue::matrix3d(1, C, P, MType::DOUBLE, alloc)
+                          : MValue::matrix(1, C, MType::DOUBLE, alloc);
+        double *dst = r.doubleDataMut();
+        for (size_t pg = 0; pg < P; ++pg)
+            for (size_t c = 0; c < C; ++c)
+                dst[pg * C + c] = reduceContiguous(kind, p + pg * pageStride + c * R, R);
+        return r;
+    }
+    if (dim == 2) {
+        auto r = d.is3D() ? MValue::matrix3d(R, 1, P, MType::DOUBLE, alloc)
+                          : MValue::matrix(R, 1, MType::DOUBLE, alloc);
+        double *dst = r.doubleDataMut();
+        for (size_t pg = 0; pg < P; ++pg)
+            for (size_t rr = 0; rr < R; ++rr)
+                dst[pg * R + rr] = reduceStrided(kind, p + pg * pageStride + rr, C, R);
+        return r;
+    }
+    if (dim == 3) {
+        auto r = MValue::matrix(R, C, MType::DOUBLE, alloc);
+        double *dst = r.doubleDataMut();
+        for (size_t c = 0; c < C; ++c)
+            for (size_t rr = 0; rr < R; ++rr)
+                dst[c * R + rr] = reduceStrided(kind, p + rr + c * R, P, pageStride);
+        return r;
+    }
+    throw std::runtime_error("Reduction dimension must be 1, 2 or 3");
+}
+
+static int defaultReduceDim(const MValue &a)
+{
+    return (a.dims().rows() > 1 || a.dims().cols() == 1) ? 1 : 2;
+}
+
 // ============================================================
 // Math functions
 // ============================================================
 void StdLibrary::registerMathFunctions(Engine &engine)
 {
     // --- sqrt ---
-    engine.registerFunction("sqrt", [&engine](const std::vector<MValue> &args) -> std::vector<MValue> {
+    engine.registerFastFunction("sqrt", [&engine](const MValue *args, size_t) -> MValue {
         auto *alloc = &engine.allocator();
         auto &a = args[0];
         if (a.isComplex())
-            return {unaryComplex(a, [](const Complex &c) { return std::sqrt(c); }, alloc)};
+            return unaryComplex(a, [](const Complex &c) { return std::sqrt(c); }, alloc);
         // Check for negative → complex result
         if (a.isScalar() && a.toScalar() < 0)
-            return {MValue::complexScalar(std::sqrt(Complex(a.toScalar(), 0.0)), alloc)};
-        return {unaryDouble(a, [](double x) { return std::sqrt(x); }, alloc)};
+            return MValue::complexScalar(std::sqrt(Complex(a.toScalar(), 0.0)), alloc);
+        return unaryDouble(a, [](double x) { return std::sqrt(x); }, alloc);
     });
 
     // --- abs ---
-    engine.registerFunction("abs", [&engine](const std::vector<MValue> &args) -> std::vector<MValue> {
+    engine.registerFastFunction("abs", [&engine](const MValue *args, size_t) -> MValue {
         auto *alloc = &engine.allocator();
         auto &a = args[0];
         if (a.isComplex()) {
             // abs of complex returns double
             if (a.isScalar())
-                return {MValue::scalar(std::abs(a.toComplex()), alloc)};
+                return MValue::scalar(std::abs(a.toComplex()), alloc);
             auto r = MValue::matrix(a.dims().rows(), a.dims().cols(), MType::DOUBLE, alloc);
             for (size_t i = 0; i < a.numel(); ++i)
                 r.doubleDataMut()[i] = std::abs(a.complexData()[i]);
-            return {r};
+            return r;
         }
-        return {unaryDouble(a, [](double x) { return std::abs(x); }, alloc)};
+        return unaryDouble(a, [](double x) { return std::abs(x); }, alloc);
     });
 
     // --- sin ---
-    engine.registerFunction("sin", [&engine](const std::vector<MValue> &args) -> std::vector<MValue> {
+    engine.registerFastFunction("sin", [&engine](const MValue *args, size_t) -> MValue {
         auto *alloc = &engine.allocator();
         auto &a = args[0];
         if (a.isComplex())
-            return {unaryComplex(a, [](const Complex &c) { return std::sin(c); }, alloc)};
-        return {unaryDouble(a, [](double x) { return std::sin(x); }, alloc)};
+            return unaryComplex(a, [](const Complex &c) { return std::sin(c); }, alloc);
+        return unaryDouble(a, [](double x) { return std::sin(x); }, alloc);
     });
 
     // --- cos ---
-    engine.registerFunction("cos", [&engine](const std::vector<MValue> &args) -> std::vector<MValue> {
+    engine.registerFastFunction("cos", [&engine](const MValue *args, size_t) -> MValue {
         auto *alloc = &engine.allocator();
         auto &a = args[0];
         if (a.isComplex())
-            return {unaryComplex(a, [](const Complex &c) { return std::cos(c); }, alloc)};
-        return {unaryDouble(a, [](double x) { return std::cos(x); }, alloc)};
+            return unaryComplex(a, [](const Complex &c) { return std::cos(c); }, alloc);
+        return unaryDouble(a, [](double x) { return std::cos(x); }, alloc);
     });
 
     // --- tan ---
-    engine.registerFunction("tan", [&engine](const std::vector<MValue> &args) -> std::vector<MValue> {
+    engine.registerFastFunction("tan", [&engine](const MValue *args, size_t) -> MValue {
         auto *alloc = &engine.allocator();
         auto &a = args[0];
         if (a.isComplex())
-            return {unaryComplex(a, [](const Complex &c) { return std::tan(c); }, alloc)};
-        return {unaryDouble(a, [](double x) { return std::tan(x); }, alloc)};
+            return unaryComplex(a, [](const Complex &c) { return std::tan(c); }, alloc);
+        return unaryDouble(a, [](double x) { return std::tan(x); }, alloc);
     });
 
     // --- exp ---
-    engine.registerFunction("exp", [&engine](const std::vector<MValue> &args) -> std::vector<MValue> {
+    engine.registerFastFunction("exp", [&engine](const MValue *args, size_t) -> MValue {
         auto *alloc = &engine.allocator();
         auto &a = args[0];
         if (a.isComplex())
-            return {unaryComplex(a, [](const Complex &c) { return std::exp(c); }, alloc)};
-        return {unaryDouble(a, [](double x) { return std::exp(x); }, alloc)};
+            return unaryComplex(a, [](const Complex &c) { return std::exp(c); }, alloc);
+        return unaryDouble(a, [](double x) { return std::exp(x); }, alloc);
     });
 
     // --- log ---
-    engine.registerFunction("log", [&engine](const std::vector<MValue> &args) -> std::vector<MValue> {
+    engine.registerFastFunction("log", [&engine](const MValue *args, size_t) -> MValue {
         auto *alloc = &engine.allocator();
         auto &a = args[0];
         if (a.isComplex())
-            return {unaryComplex(a, [](const Complex &c) { return std::log(c); }, alloc)};
+            return unaryComplex(a, [](const Complex &c) { return std::log(c); }, alloc);
         if (a.isScalar() && a.toScalar() < 0)
-            return {MValue::complexScalar(std::log(Complex(a.toScalar(), 0.0)), alloc)};
-        return {unaryDouble(a, [](double x) { return std::log(x); }, alloc)};
+            return MValue::complexScalar(std::log(Complex(a.toScalar(), 0.0)), alloc);
+        return unaryDouble(a, [](double x) { return std::log(x); }, alloc);
     });
 
     // --- log2 ---
-    engine.registerFunction("log2", [&engine](const std::vector<MValue> &args) -> std::vector<MValue> {
+    engine.registerFastFunction("log2", [&engine](const MValue *args, size_t) -> MValue {
         auto *alloc = &engine.allocator();
-        return {unaryDouble(args[0], [](double x) { return std::log2(x); }, alloc)};
+        return unaryDouble(args[0], [](double x) { return std::log2(x); }, alloc);
     });
 
     // --- log10 ---
-    engine
-        .registerFunction("log10", [&engine](const std::vector<MValue> &args) -> std::vector<MValue> {
-            auto *alloc = &engine.allocator();
-            return {unaryDouble(args[0], [](double x) { return std::log10(x); }, alloc)};
-        });
+    engine.registerFastFunction("log10", [&engine](const MValue *args, size_t) -> MValue {
+        auto *alloc = &engine.allocator();
+        return unaryDouble(args[0], [](double x) { return std::log10(x); }, alloc);
+    });
 
     // --- floor ---
-    engine
-        .registerFunction("floor", [&engine](const std::vector<MValue> &args) -> std::vector<MValue> {
-            auto *alloc = &engine.allocator();
-            return {unaryDouble(args[0], [](double x) { return std::floor(x); }, alloc)};
-        });
+    engine.registerFastFunction("floor", [&engine](const MValue *args, size_t) -> MValue {
+        auto *alloc = &engine.allocator();
+        return unaryDouble(args[0], [](double x) { return std::floor(x); }, alloc);
+    });
 
     // --- ceil ---
-    engine.registerFunction("ceil", [&engine](const std::vector<MValue> &args) -> std::vector<MValue> {
+    engine.registerFastFunction("ceil", [&engine](const MValue *args, size_t) -> MValue {
         auto *alloc = &engine.allocator();
-        return {unaryDouble(args[0], [](double x) { return std::ceil(x); }, alloc)};
+        return unaryDouble(args[0], [](double x) { return std::ceil(x); }, alloc);
     });
 
     // --- round ---
-    engine
-        .registerFunction("round", [&engine](const std::vector<MValue> &args) -> std::vector<MValue> {
-            auto *alloc = &engine.allocator();
-            return {unaryDouble(args[0], [](double x) { return std::round(x); }, alloc)};
-        });
+    engine.registerFastFunction("round", [&engine](const MValue *args, size_t) -> MValue {
+        auto *alloc = &engine.allocator();
+        return unaryDouble(args[0], [](double x) { return std::round(x); }, alloc);
+    });
 
     // --- fix (truncate toward zero) ---
-    engine.registerFunction("fix", [&engine](const std::vector<MValue> &args) -> std::vector<MValue> {
+    engine.registerFastFunction("fix", [&engine](const MValue *args, size_t) -> MValue {
         auto *alloc = &engine.allocator();
-        return {unaryDouble(args[0], [](double x) { return std::trunc(x); }, alloc)};
+        return unaryDouble(args[0], [](double x) { return std::trunc(x); }, alloc);
     });
 
     // --- mod ---
-    engine.registerFunction("mod", [&engine](const std::vector<MValue> &args) -> std::vector<MValue> {
+    engine.registerFastFunction("mod", [&engine](const MValue *args, size_t) -> MValue {
         auto *alloc = &engine.allocator();
-        return {elementwiseDouble(
+        return elementwiseDouble(
             args[0],
             args[1],
             [](double a, double b) { return b != 0 ? a - std::floor(a / b) * b : a; },
-            alloc)};
+            alloc);
     });
 
     // --- rem ---
-    engine.registerFunction("rem", [&engine](const std::vector<MValue> &args) -> std::vector<MValue> {
+    engine.registerFastFunction("rem", [&engine](const MValue *args, size_t) -> MValue {
         auto *alloc = &engine.allocator();
-        return {elementwiseDouble(
-            args[0], args[1], [](double a, double b) { return std::fmod(a, b); }, alloc)};
+        return elementwiseDouble(
+            args[0], args[1], [](double a, double b) { return std::fmod(a, b); }, alloc);
     });
 
     // --- sign ---
-    engine.registerFunction("sign",
-                            [&engine](const std::vector<MValue> &args) -> std::vector<MValue> {
-                                auto *alloc = &engine.allocator();
-                                return {unaryDouble(
-                                    args[0],
-                                    [](double x) { return (x > 0) ? 1.0 : (x < 0 ? -1.0 : 0.0); },
-                                    alloc)};
-                            });
+    engine.registerFastFunction("sign", [&engine](const MValue *args, size_t) -> MValue {
+        auto *alloc = &engine.allocator();
+        return unaryDouble(
+            args[0], [](double x) { return (x > 0) ? 1.0 : (x < 0 ? -1.0 : 0.0); }, alloc);
+    });
 
     // --- max ---
     engine.registerFunction("max", [&engine](const std::vector<MValue> &args) -> std::vector<MValue> {
@@ -686,26 +1072,36 @@ void StdLibrary::registerMathFunctions(Engine &engine)
             return {elementwiseDouble(
                 args[0], args[1], [](double a, double b) { return std::max(a, b); }, alloc)};
         auto &a = args[0];
+        if (a.isEmpty())
+            return {MValue::matrix(1, 0, MType::DOUBLE, alloc)};
+        if (args.size() == 3 && args[1].isEmpty()) {
+            // max(A, [], dim) — must precede the integer whole-array scan
+            // so the dim argument is never silently ignored.
+            if (isIntegerType(a.type()))
+                throw std::runtime_error(
+                    "max: dimension argument is not supported for integer arrays");
+            int dim = static_cast<int>(args[2].toScalar());
+            return {reduceDouble(ReduceKind::MAX, a, dim, alloc)};
+        }
+        if (isIntegerType(a.type())) {
+            return {intDispatch(a.type(), [&](auto tag) -> MValue {
+                using T = decltype(tag);
+                const T *p = static_cast<const T *>(a.rawData());
+                T best = p[0];
+                for (size_t i = 1; i < a.numel(); ++i)
+                    best = std::max(best, p[i]);
+                auto r = MValue::matrix(1, 1, a.type(), alloc);
+                *static_cast<T *>(r.rawDataMut()) = best;
+                return r;
+            })};
+        }
         if (a.dims().isVector() || a.isScalar()) {
-            double mx = a.doubleData()[0];
-            size_t mi = 0;
-            for (size_t i = 1; i < a.numel(); ++i)
-                if (a.doubleData()[i] > mx) {
-                    mx = a.doubleData()[i];
-                    mi = i;
-                }
+            double mx;
+            size_t mi;
+            kernels::reduceMax(a.doubleData(), a.numel(), mx, mi);
             return {MValue::scalar(mx, alloc), MValue::scalar(static_cast<double>(mi + 1), alloc)};
         }
-        // Column-wise max
-        size_t R = a.dims().rows(), C = a.dims().cols();
-        auto r = MValue::matrix(1, C, MType::DOUBLE, alloc);
-        for (size_t c = 0; c < C; ++c) {
-            double mx = a(0, c);
-            for (size_t rr = 1; rr < R; ++rr)
-                mx = std::max(mx, a(rr, c));
-            r.doubleDataMut()[c] = mx;
-        }
-        return {r};
+        return {reduceDouble(ReduceKind::MAX, a, 1, alloc)};
     });
 
     // --- min ---
@@ -715,25 +1111,36 @@ void StdLibrary::registerMathFunctions(Engine &engine)
             return {elementwiseDouble(
                 args[0], args[1], [](double a, double b) { return std::min(a, b); }, alloc)};
         auto &a = args[0];
+        if (a.isEmpty())
+            return {MValue::matrix(1, 0, MType::DOUBLE, alloc)};
+        if (args.size() == 3 && args[1].isEmpty()) {
+            // min(A, [], dim) — must precede the integer whole-array scan
+            // so the dim argument is never silently ignored.
+            if (isIntegerType(a.type()))
+                throw std::runtime_error(
+                    "min: dimension argument is not supported for integer arrays");
+            int dim = static_cast<int>(args[2].toScalar());
+            return {reduceDouble(ReduceKind::MIN, a, dim, alloc)};
+        }
+        if (isIntegerType(a.type())) {
+            return {intDispatch(a.type(), [&](auto tag) -> MValue {
+                using T = decltype(tag);
+                const T *p = static_cast<const T *>(a.rawData());
+                T best = p[0];
+                for (size_t i = 1; i < a.numel(); ++i)
+                    best = std::min(best, p[i]);
+                auto r = MValue::matrix(1, 1, a.type(), alloc);
+                *static_cast<T *>(r.rawDataMut()) = best;
+                return r;
+            })};
+        }
         if (a.dims().isVector() || a.isScalar()) {
-            double mn = a.doubleData()[0];
-            size_t mi = 0;
-            for (size_t i = 1; i < a.numel(); ++i)
-                if (a.doubleData()[i] < mn) {
-                    mn = a.doubleData()[i];
-                    mi = i;
-                }
+            double mn;
+            size_t mi;
+            kernels::reduceMin(a.doubleData(), a.numel(), mn, mi);
             return {MValue::scalar(mn, alloc), MValue::scalar(static_cast<double>(mi + 1), alloc)};
         }
-        size_t R = a.dims().rows(), C = a.dims().cols();
-        auto r = MValue::matrix(1, C, MType::DOUBLE, alloc);
-        for (size_t c = 0; c < C; ++c) {
-            double mn = a(0, c);
-            for (size_t rr = 1; rr < R; ++rr)
-                mn = std::min(mn, a(rr, c));
-            r.doubleDataMut()[c] = mn;
-        }
-        return {r};
+        return {reduceDouble(ReduceKind::MIN, a, 1, alloc)};
     });
 
     // --- sum ---
@@ -741,21 +1148,37 @@ void StdLibrary::registerMathFunctions(Engine &engine)
                             [&engine](const std::vector<MValue> &args) -> std::vector<MValue> {
                                 auto *alloc = &engine.allocator();
                                 auto &a = args[0];
-                                if (a.dims().isVector() || a.isScalar()) {
+                                if (a.isEmpty())
+                                    return {MValue::matrix(1, 0, MType::DOUBLE, alloc)};
+                                if (a.isRange()) {
                                     double s = 0;
                                     for (size_t i = 0; i < a.numel(); ++i)
-                                        s += a.doubleData()[i];
+                                        s += a(i);
                                     return {MValue::scalar(s, alloc)};
                                 }
-                                size_t R = a.dims().rows(), C = a.dims().cols();
-                                auto r = MValue::matrix(1, C, MType::DOUBLE, alloc);
-                                for (size_t c = 0; c < C; ++c) {
-                                    double s = 0;
-                                    for (size_t rr = 0; rr < R; ++rr)
-                                        s += a(rr, c);
-                                    r.doubleDataMut()[c] = s;
+                                if (isIntegerType(a.type())) {
+                                    // Type-preserving saturating accumulate.
+                                    return {intDispatch(a.type(), [&](auto tag) -> MValue {
+                                        using T = decltype(tag);
+                                        const T *p = static_cast<const T *>(a.rawData());
+                                        T acc = 0;
+                                        for (size_t i = 0; i < a.numel(); ++i)
+                                            acc = satAdd<T>(acc, p[i]);
+                                        auto r = MValue::matrix(1, 1, a.type(), alloc);
+                                        *static_cast<T *>(r.rawDataMut()) = acc;
+                                        return r;
+                                    })};
                                 }
-                                return {r};
+                                if (args.size() >= 2) {
+                                    int dim = static_cast<int>(args[1].toScalar());
+                                    return {reduceDouble(ReduceKind::SUM, a, dim, alloc)};
+                                }
+                                if (a.dims().isVector() || a.isScalar())
+                                    return {MValue::scalar(kernels::reduceSum(a.doubleData(),
+                                                                              a.numel()),
+                                                           alloc)};
+                                return {reduceDouble(ReduceKind::SUM, a, defaultReduceDim(a),
+                                                     alloc)};
                             });
 
     // --- prod ---
@@ -763,21 +1186,18 @@ void StdLibrary::registerMathFunctions(Engine &engine)
                             [&engine](const std::vector<MValue> &args) -> std::vector<MValue> {
                                 auto *alloc = &engine.allocator();
                                 auto &a = args[0];
-                                if (a.dims().isVector() || a.isScalar()) {
-                                    double p = 1;
-                                    for (size_t i = 0; i < a.numel(); ++i)
-                                        p *= a.doubleData()[i];
-                                    return {MValue::scalar(p, alloc)};
+                                if (a.isEmpty())
+                                    return {MValue::matrix(1, 0, MType::DOUBLE, alloc)};
+                                if (args.size() >= 2) {
+                                    int dim = static_cast<int>(args[1].toScalar());
+                                    return {reduceDouble(ReduceKind::PROD, a, dim, alloc)};
                                 }
-                                size_t R = a.dims().rows(), C = a.dims().cols();
-                                auto r = MValue::matrix(1, C, MType::DOUBLE, alloc);
-                                for (size_t c = 0; c < C; ++c) {
-                                    double p = 1;
-                                    for (size_t rr = 0; rr < R; ++rr)
-                                        p *= a(rr, c);
-                                    r.doubleDataMut()[c] = p;
-                                }
-                                return {r};
+                                if (a.dims().isVector() || a.isScalar())
+                                    return {MValue::scalar(kernels::reduceProd(a.doubleData(),
+                                                                               a.numel()),
+                                                           alloc)};
+                                return {reduceDouble(ReduceKind::PROD, a, defaultReduceDim(a),
+                                                     alloc)};
                             });
 
     // --- mean ---
@@ -785,22 +1205,26 @@ void StdLibrary::registerMathFunctions(Engine &engine)
                             [&engine](const std::vector<MValue> &args) -> std::vector<MValue> {
                                 auto *alloc = &engine.allocator();
                                 auto &a = args[0];
-                                if (a.dims().isVector() || a.isScalar()) {
+                                if (a.isEmpty())
+                                    return {MValue::matrix(1, 0, MType::DOUBLE, alloc)};
+                                if (a.isRange()) {
                                     double s = 0;
                                     for (size_t i = 0; i < a.numel(); ++i)
-                                        s += a.doubleData()[i];
+                                        s += a(i);
                                     return {
                                         MValue::scalar(s / static_cast<double>(a.numel()), alloc)};
                                 }
-                                size_t R = a.dims().rows(), C = a.dims().cols();
-                                auto r = MValue::matrix(1, C, MType::DOUBLE, alloc);
-                                for (size_t c = 0; c < C; ++c) {
-                                    double s = 0;
-                                    for (size_t rr = 0; rr < R; ++rr)
-                                        s += a(rr, c);
-                                    r.doubleDataMut()[c] = s / static_cast<double>(R);
+                                if (args.size() >= 2) {
+                                    int dim = static_cast<int>(args[1].toScalar());
+                                    return {reduceDouble(ReduceKind::MEAN, a, dim, alloc)};
                                 }
-                                return {r};
+                                if (a.dims().isVector() || a.isScalar())
+                                    return {MValue::scalar(kernels::reduceSum(a.doubleData(),
+                                                                              a.numel())
+                                                               / static_cast<double>(a.numel()),
+                                                           alloc)};
+                                return {reduceDouble(ReduceKind::MEAN, a, defaultReduceDim(a),
+                                                     alloc)};
                             });
 
     // --- linspace ---
@@ -1009,7 +1433,20 @@ void StdLibrary::registerMatrixFunctions(Engine &engine)
                                 std::vector<double> indices;
                                 if (a.isLogical()) {
                                     const uint8_t *ld = a.logicalData();
-                                    for (size_t i = 0; i < a.numel(); ++i)
+                                    size_t n = a.numel();
+                                    indices.reserve(kernels::logicalCount(ld, n));
+                                    size_t i = 0;
+                                    for (; i + 8 <= n; i += 8) {
+                                        uint64_t w;
+                                        std::memcpy(&w, ld + i, 8);
+                                        if (!w)
+                                            continue; // skip 8 false entries at once
+                                        for (size_t k = 0; k < 8; ++k)
+                                            if (ld[i + k])
+                                                indices.push_back(
+                                                    static_cast<double>(i + k + 1));
+                                    }
+                                    for (; i < n; ++i)
                                         if (ld[i])
                                             indices.push_back(static_cast<double>(i + 1));
                                 } else {
@@ -1118,6 +1555,45 @@ void StdLibrary::registerIOFunctions(Engine &engine)
             std::cerr << "Warning: " << args[0].toString() << "\n";
         return {};
     });
+
+    engine.registerFunction("profile",
+                            [&engine](const std::vector<MValue> &args) -> std::vector<MValue> {
+                                if (!args.empty() && args[0].isChar()) {
+                                    std::string cmd = args[0].toString();
+                                    if (cmd == "on") {
+                                        engine.resetProfile();
+                                        engine.setProfiling(true);
+                                        return {};
+                                    }
+                                    if (cmd == "off") {
+                                        engine.setProfiling(false);
+                                        return {};
+                                    }
+                                    if (cmd == "reset") {
+                                        engine.resetProfile();
+                                        return {};
+                                    }
+                                    throw std::runtime_error("profile: unknown command '" + cmd
+                                                             + "'");
+                                }
+                                return {engine.profileReport()};
+                            });
+
+    engine.registerFunction("save",
+                            [&engine](const std::vector<MValue> &args) -> std::vector<MValue> {
+                                if (args.empty() || !args[0].isChar())
+                                    throw std::runtime_error("save requires a file name");
+                                engine.saveWorkspace(args[0].toString());
+                                return {};
+                            });
+
+    engine.registerFunction("load",
+                            [&engine](const std::vector<MValue> &args) -> std::vector<MValue> {
+                                if (args.empty() || !args[0].isChar())
+                                    throw std::runtime_error("load requires a file name");
+                                engine.loadWorkspace(args[0].toString());
+                                return {};
+                            });
 }
 
 // ============================================================
@@ -1131,6 +1607,19 @@ void StdLibrary::registerTypeFunctions(Engine &engine)
                                 auto &a = args[0];
                                 if (a.type() == MType::DOUBLE)
                                     return {a};
+                                if (isIntegerType(a.type())) {
+                                    auto r = MValue::matrix(a.dims().rows(), a.dims().cols(),
+                                                            MType::DOUBLE, alloc);
+                                    double *dst = r.doubleDataMut();
+                                    intDispatch(a.type(), [&](auto tag) -> MValue {
+                                        using T = decltype(tag);
+                                        const T *p = static_cast<const T *>(a.rawData());
+                                        for (size_t i = 0; i < a.numel(); ++i)
+                                            dst[i] = static_cast<double>(p[i]);
+                                        return MValue::empty();
+                                    });
+                                    return {r};
+                                }
                                 if (a.isLogical())
                                     return {MValue::scalar(a.toBool() ? 1.0 : 0.0, alloc)};
                                 if (a.isChar())
@@ -1269,11 +1758,9 @@ void StdLibrary::registerCellStructFunctions(Engine &engine)
                                 auto &a = args[0];
                                 if (!a.isStruct())
                                     throw std::runtime_error("fieldnames requires a struct");
-                                auto &fields = a.structFields();
-                                auto c = MValue::cell(fields.size(), 1);
-                                size_t i = 0;
-                                for (auto &[k, v] : fields)
-                                    c.cellAt(i++) = MValue::fromString(k, alloc);
+                                auto c = MValue::cell(a.fieldCount(), 1);
+                                for (size_t i = 0; i < a.fieldCount(); ++i)
+                                    c.cellAt(i) = MValue::fromString(a.fieldNameAt(i), alloc);
                                 return {c};
                             });
 
@@ -1290,7 +1777,7 @@ void StdLibrary::registerCellStructFunctions(Engine &engine)
         auto s = args[0];
         if (!s.isStruct())
             throw std::runtime_error("rmfield requires a struct");
-        s.structFields().erase(args[1].toString());
+        s.removeField(args[1].toString());
         return {s};
     });
 
@@ -1301,11 +1788,234 @@ void StdLibrary::registerCellStructFunctions(Engine &engine)
     });
 }
 
+// ============================================================
+// Functional application: arrayfun / cellfun
+// ============================================================
+namespace {
+
+struct MapFunOptions
+{
+    bool uniformOutput = true;
+    bool useParallel = false;
+    size_t numData = 0; // data arguments following the handle
+};
+
+MapFunOptions parseMapFunOptions(const char *fname, const std::vector<MValue> &args)
+{
+    if (args.empty() || !args[0].isFuncHandle())
+        throw std::runtime_error(std::string(fname) + " requires a function handle");
+
+    MapFunOptions opts;
+    size_t i = 1;
+    while (i < args.size() && !args[i].isChar())
+        ++i;
+    opts.numData = i - 1;
+    if (opts.numData == 0)
+        throw std::runtime_error(std::string(fname) + " requires at least one data argument");
+
+    while (i < args.size()) {
+        if (!args[i].isChar() || i + 1 >= args.size())
+            throw std::runtime_error(std::string(fname)
+                                     + ": options must be name/value pairs");
+        std::string key = args[i].toString();
+        if (key == "UniformOutput")
+            opts.uniformOutput = args[i + 1].toBool();
+        else if (key == "UseParallel")
+            opts.useParallel = args[i + 1].toBool();
+        else
+            throw std::runtime_error(std::string(fname) + ": unknown option '" + key + "'");
+        i += 2;
+    }
+    return opts;
+}
+
+// Applies the handle over [0, n) with element extraction supplied by the
+// caller. Parallel mode chunks the range over the shared ThreadPool with
+// a per-call Environment per invocation; the first exception wins and is
+// rethrown on the caller.
+template<typename ElemFn>
+MValue mapFunApply(Engine &engine,
+                   const char *fname,
+                   const MValue &handle,
+                   const MapFunOptions &opts,
+                   const Dims &shape,
+                   size_t numInputs,
+                   size_t n,
+                   const ElemFn &elemAt)
+{
+    auto *alloc = &engine.allocator();
+    MValue result = opts.uniformOutput
+                        ? MValue::matrix(shape.rows(), shape.cols(), MType::DOUBLE, alloc)
+                        : MValue::cell(shape.rows(), shape.cols());
+    double *out = opts.uniformOutput ? result.doubleDataMut() : nullptr;
+    std::vector<MValue> *cells = opts.uniformOutput ? nullptr : &result.cellDataVec();
+
+    std::mutex errorMutex;
+    std::exception_ptr firstError;
+
+    auto runChunk = [&](size_t lo, size_t hi) {
+        try {
+            std::vector<MValue> callArgs(numInputs);
+            for (size_t i = lo; i < hi; ++i) {
+                for (size_t a = 0; a < numInputs; ++a)
+                    callArgs[a] = elemAt(a, i);
+                MValue r = engine.callHandle(handle, callArgs);
+                if (opts.uniformOutput) {
+                    if (!r.isScalar() || !(r.isNumeric() || r.isLogical()))
+                        throw std::runtime_error(
+                            std::string(fname)
+                            + ": function must return a scalar; set 'UniformOutput' to false");
+                    out[i] = r.toScalar();
+                } else {
+                    (*cells)[i] = std::move(r);
+                }
+            }
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(errorMutex);
+            if (!firstError)
+                firstError = std::current_exception();
+        }
+    };
+
+    if (opts.useParallel && n > 1) {
+        // Chunk generously: each element is a full interpreter call, so
+        // modest chunks already amortize the scheduling overhead.
+        ThreadPool::global().parallelFor(0, n, 16, runChunk);
+    } else {
+        runChunk(0, n);
+    }
+
+    if (firstError)
+        std::rethrow_exception(firstError);
+    return result;
+}
+
+} // namespace
+
+void StdLibrary::registerFunctionalFunctions(Engine &engine)
+{
+    engine.registerFunction("arrayfun",
+                            [&engine](const std::vector<MValue> &args) -> std::vector<MValue> {
+                                auto opts = parseMapFunOptions("arrayfun", args);
+                                auto *alloc = &engine.allocator();
+
+                                size_t n = args[1].numel();
+                                for (size_t a = 0; a < opts.numData; ++a) {
+                                    const MValue &d = args[1 + a];
+                                    if (d.type() != MType::DOUBLE && !d.isLogical())
+                                        throw std::runtime_error(
+                                            "arrayfun supports double and logical arrays");
+                                    if (d.numel() != n)
+                                        throw std::runtime_error(
+                                            "arrayfun: all inputs must have the same size");
+                                    d.rawData(); // materialize ranges before parallel reads
+                                }
+
+                                auto elemAt = [&](size_t a, size_t i) -> MValue {
+                                    const MValue &d = args[1 + a];
+                                    if (d.isLogical())
+                                        return MValue::logicalScalar(d.logicalData()[i] != 0,
+                                                                     alloc);
+                                    return MValue::scalar(d(i), alloc);
+                                };
+                                return {mapFunApply(engine, "arrayfun", args[0], opts,
+                                                    args[1].dims(), opts.numData, n, elemAt)};
+                            });
+
+    engine.registerFunction("cellfun",
+                            [&engine](const std::vector<MValue> &args) -> std::vector<MValue> {
+                                auto opts = parseMapFunOptions("cellfun", args);
+
+                                size_t n = args[1].numel();
+                                for (size_t a = 0; a < opts.numData; ++a) {
+                                    if (!args[1 + a].isCell())
+                                        throw std::runtime_error(
+                                            "cellfun requires cell array inputs");
+                                    if (args[1 + a].numel() != n)
+                                        throw std::runtime_error(
+                                            "cellfun: all inputs must have the same size");
+                                }
+
+                                auto elemAt = [&](size_t a, size_t i) -> MValue {
+                                    return args[1 + a].cellAt(i);
+                                };
+                                return {mapFunApply(engine, "cellfun", args[0], opts,
+                                                    args[1].dims(), opts.numData, n, elemAt)};
+                            });
+}
+
+// ============================================================
+// Integer type functions
+// ============================================================
+void StdLibrary::registerIntegerFunctions(Engine &engine)
+{
+    struct NamedType
+    {
+        const char *name;
+        MType type;
+    };
+    static const NamedType kIntTypes[] = {
+        {"int8", MType::INT8},     {"int16", MType::INT16},   {"int32", MType::INT32},
+        {"int64", MType::INT64},   {"uint8", MType::UINT8},   {"uint16", MType::UINT16},
+        {"uint32", MType::UINT32}, {"uint64", MType::UINT64},
+    };
+
+    for (const auto &nt : kIntTypes) {
+        MType t = nt.type;
+        engine.registerFastFunction(nt.name, [&engine, t](const MValue *args, size_t) -> MValue {
+            auto *alloc = &engine.allocator();
+            return intDispatch(t, [&](auto tag) -> MValue {
+                using T = decltype(tag);
+                return intFromDouble<T>(args[0], t, alloc);
+            });
+        });
+    }
+
+    engine.registerFastFunction("isinteger", [&engine](const MValue *args, size_t) -> MValue {
+        return MValue::logicalScalar(isIntegerType(args[0].type()), &engine.allocator());
+    });
+
+}
+
 // ============================================================
 // String functions
 // ============================================================
 void StdLibrary::registerStringFunctions(Engine &engine)
 {
+    // --- string array constructor: one pooled buffer for all entries ---
+    engine.registerFastFunction("string", [](const MValue *args, size_t) -> MValue {
+        const MValue &a = args[0];
+        if (a.isStringArray())
+            return a;
+        if (a.isChar())
+            return MValue::stringArray({a.toString()});
+        if (a.isCell()) {
+            std::string chars;
+            std::vector<size_t> offsets;
+            offsets.reserve(a.numel() + 1);
+            offsets.push_back(0);
+            for (size_t i = 0; i < a.numel(); ++i) {
+                chars += a.cellAt(i).toString();
+                offsets.push_back(chars.size());
+            }
+            return MValue::stringArrayFromPool(std::move(chars), std::move(offsets));
+        }
+        throw std::runtime_error("string() requires char or cell-of-char input");
+    });
+
+    engine.registerFunction("cellstr",
+                            [&engine](const std::vector<MValue> &args) -> std::vector<MValue> {
+                                auto *alloc = &engine.allocator();
+                                const MValue &a = args[0];
+                                if (!a.isStringArray())
+                                    throw std::runtime_error("cellstr requires a string array");
+                                auto c = MValue::cell(1, a.numel());
+                                for (size_t i = 0; i < a.numel(); ++i)
+                                    c.cellAt(i) = MValue::fromString(std::string(a.stringAt(i)),
+                                                                     alloc);
+                                return {c};
+                            });
+
     engine.registerFunction("num2str",
                             [&engine](const std::vector<MValue> &args) -> std::vector<MValue> {
                                 auto *alloc = &engine.allocator();
@@ -1338,9 +2048,29 @@ void StdLibrary::registerStringFunctions(Engine &engine)
     engine.registerFunction("strcmp",
                             [&engine](const std::vector<MValue> &args) -> std::vector<MValue> {
                                 auto *alloc = &engine.allocator();
-                                return {
-                                    MValue::logicalScalar(args[0].toString() == args[1].toString(),
-                                                          alloc)};
+                                const MValue &a = args[0];
+                                const MValue &b = args[1];
+                                // String-array forms compare whole arrays in one pass.
+                                if (a.isStringArray() || b.isStringArray()) {
+                                    const MValue &sa = a.isStringArray() ? a : b;
+                                    const MValue &other = a.isStringArray() ? b : a;
+                                    auto r = MValue::matrix(1, sa.numel(), MType::LOGICAL, alloc);
+                                    uint8_t *dst = r.logicalDataMut();
+                                    if (other.isStringArray()) {
+                                        if (other.numel() != sa.numel())
+                                            throw std::runtime_error(
+                                                "strcmp: string arrays must be the same size");
+                                        for (size_t i = 0; i < sa.numel(); ++i)
+                                            dst[i] = sa.stringAt(i) == other.stringAt(i) ? 1 : 0;
+                                    } else {
+                                        std::string needle = other.toString();
+                                        for (size_t i = 0; i < sa.numel(); ++i)
+                                            dst[i] = sa.stringAt(i) == needle ? 1 : 0;
+                                    }
+                                    return {r};
+                                }
+                                return {MValue::logicalScalar(a.toString() == b.toString(),
+                                                              alloc)};
                             });
 
     engine.registerFunction("strcmpi",
@@ -1355,6 +2085,14 @@ void StdLibrary::registerStringFunctions(Engine &engine)
     engine.registerFunction("upper",
                             [&engine](const std::vector<MValue> &args) -> std::vector<MValue> {
                                 auto *alloc = &engine.allocator();
+                                if (args[0].isStringArray()) {
+                                    // Single pass over the pooled buffer; offsets unchanged.
+                                    std::string chars(args[0].pooledChars());
+                                    std::transform(chars.begin(), chars.end(), chars.begin(),
+                                                   ::toupper);
+                                    return {MValue::stringArrayFromPool(std::move(chars),
+                                                                        args[0].stringOffsets())};
+                                }
                                 std::string s = args[0].toString();
                                 std::transform(s.begin(), s.end(), s.begin(), ::toupper);
                                 return {MValue::fromString(s, alloc)};
@@ -1363,6 +2101,13 @@ void StdLibrary::registerStringFunctions(Engine &engine)
     engine.registerFunction("lower",
                             [&engine](const std::vector<MValue> &args) -> std::vector<MValue> {
                                 auto *alloc = &engine.allocator();
+                                if (args[0].isStringArray()) {
+                                    std::string chars(args[0].pooledChars());
+                                    std::transform(chars.begin(), chars.end(), chars.begin(),
+                                                   ::tolower);
+                                    return {MValue::stringArrayFromPool(std::move(chars),
+                                                                        args[0].stringOffsets())};
+                                }
                                 std::string s = args[0].toString();
                                 std::transform(s.begin(), s.end(), s.begin(), ::tolower);
                                 return {MValue::fromString(s, alloc)};
@@ -1371,12 +2116,31 @@ void StdLibrary::registerStringFunctions(Engine &engine)
     engine.registerFunction("strtrim",
                             [&engine](const std::vector<MValue> &args) -> std::vector<MValue> {
                                 auto *alloc = &engine.allocator();
+                                auto trim = [](std::string_view s) -> std::string_view {
+                                    size_t start = s.find_first_not_of(" \t\r\n");
+                                    if (start == std::string_view::npos)
+                                        return {};
+                                    size_t end = s.find_last_not_of(" \t\r\n");
+                                    return s.substr(start, end - start + 1);
+                                };
+                                if (args[0].isStringArray()) {
+                                    const MValue &a = args[0];
+                                    std::string chars;
+                                    chars.reserve(a.stringBytes());
+                                    std::vector<size_t> offsets;
+                                    offsets.reserve(a.numel() + 1);
+                                    offsets.push_back(0);
+                                    for (size_t i = 0; i < a.numel(); ++i) {
+                                        auto t = trim(a.stringAt(i));
+                                        chars.append(t.data(), t.size());
+                                        offsets.push_back(chars.size());
+                                    }
+                                    return {MValue::stringArrayFromPool(std::move(chars),
+                                                                        std::move(offsets))};
+                                }
                                 std::string s = args[0].toString();
-                                size_t start = s.find_first_not_of(" \t\r\n");
-                                size_t end = s.find_last_not_of(" \t\r\n");
-                                if (start == std::string::npos)
-                                    return {MValue::fromString("", alloc)};
-                                return {MValue::fromString(s.substr(start, end - start + 1), alloc)};
+                                auto t = trim(s);
+                                return {MValue::fromString(std::string(t), alloc)};
                             });
 
     engine.registerFunction("strsplit",
@@ -0,0 +1,103 @@
+// src/MLabThreadPool.cpp
+#include "MLabThreadPool.hpp"
+
+#include <algorithm>
+
+namespace mlab {
+
+// Nested parallelFor from inside a worker runs inline: blocking a worker
+// on its own pool would deadlock the completion wait.
+static thread_local bool tlsInsideWorker = false;
+
+ThreadPool &ThreadPool::global()
+{
+#if defined(__EMSCRIPTEN__)
+    static ThreadPool pool(0);
+#else
+    static ThreadPool pool(std::thread::hardware_concurrency() > 1
+                               ? std::thread::hardware_concurrency() - 1
+                               : 0);
+#endif
+    return pool;
+}
+
+ThreadPool::ThreadPool(size_t numThreads)
+{
+    threads_.reserve(numThreads);
+    for (size_t i = 0; i < numThreads; ++i)
+        threads_.emplace_back([this] { workerLoop(); });
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    taskReady_.notify_all();
+    for (auto &t : threads_)
+        t.join();
+}
+
+void ThreadPool::workerLoop()
+{
+    tlsInsideWorker = true;
+    for (;;) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            taskReady_.wait(lock, [this] { return stopping_ || !tasks_.empty(); });
+            if (stopping_ && tasks_.empty())
+                return;
+            task = std::move(tasks_.front());
+            tasks_.pop();
+        }
+        task();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            --pendingTasks_;
+        }
+        taskDone_.notify_all();
+    }
+}
+
+void ThreadPool::parallelFor(size_t begin,
+                             size_t end,
+                             size_t grain,
+                             const std::function<void(size_t, size_t)> &fn)
+{
+    if (end <= begin)
+        return;
+    if (tlsInsideWorker) {
+        fn(begin, end);
+        return;
+    }
+
+    size_t total = end - begin;
+    size_t workers = threads_.size() + 1; // workers plus the caller
+    size_t chunk = std::max(grain, (total + workers - 1) / workers);
+
+    if (threads_.empty() || total <= chunk) {
+        fn(begin, end);
+        return;
+    }
+
+    // Queue every chunk except the first, which runs on the caller.
+    size_t firstEnd = std::min(begin + chunk, end);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (size_t lo = firstEnd; lo < end; lo += chunk) {
+            size_t hi = std::min(lo + chunk, end);
+            tasks_.push([&fn, lo, hi] { fn(lo, hi); });
+            ++pendingTasks_;
+        }
+    }
+    taskReady_.notify_all();
+
+    fn(begin, firstEnd);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    taskDone_.wait(lock, [this] { return pendingTasks_ == 0; });
+}
+
+} // namespace mlab
@@ -2,8 +2,11 @@
 
 #include <algorithm>
 #include <cstring>
+#include <deque>
+#include <mutex>
 #include <sstream>
 #include <stdexcept>
+#include <unordered_map>
 
 namespace mlab {
 
@@ -29,6 +32,8 @@ const char *mtypeName(MType t)
         return "struct";
     case MType::FUNC_HANDLE:
         return "function_handle";
+    case MType::STRING:
+        return "string";
     case MType::INT8:
         return "int8";
     case MType::INT16:
@@ -81,6 +86,50 @@ size_t elementSize(MType t)
     }
 }
 
+bool isIntegerType(MType t)
+{
+    switch (t) {
+    case MType::INT8:
+    case MType::INT16:
+    case MType::INT32:
+    case MType::INT64:
+    case MType::UINT8:
+    case MType::UINT16:
+    case MType::UINT32:
+    case MType::UINT64:
+        return true;
+    default:
+        return false;
+    }
+}
+
+// ============================================================
+// Field-name interning
+// ============================================================
+namespace {
+std::mutex fieldTableMutex;
+std::unordered_map<std::string, uint32_t> fieldIdByName;
+std::deque<std::string> fieldNameTable; // deque: references stay stable
+} // namespace
+
+uint32_t internFieldName(const std::string &name)
+{
+    std::lock_guard<std::mutex> lock(fieldTableMutex);
+    auto it = fieldIdByName.find(name);
+    if (it != fieldIdByName.end())
+        return it->second;
+    uint32_t id = static_cast<uint32_t>(fieldNameTable.size());
+    fieldNameTable.push_back(name);
+    fieldIdByName.emplace(name, id);
+    return id;
+}
+
+const std::string &fieldNameById(uint32_t id)
+{
+    std::lock_guard<std::mutex> lock(fieldTableMutex);
+    return fieldNameTable[id];
+}
+
 // ============================================================
 // Dims
 // ============================================================
@@ -187,16 +236,19 @@ bool Dims::operator!=(const Dims &o) const
 // ============================================================
 // DataBuffer
 // ============================================================
-DataBuffer::DataBuffer(size_t bytes, Allocator *alloc)
+DataBuffer::DataBuffer(size_t bytes, Allocator *alloc, size_t capacityBytes)
     : bytes_(bytes)
+    , capacity_(std::max(bytes, capacityBytes))
     , refCount_(1)
     , allocator_(alloc)
 {
-    if (bytes > 0) {
-        if (alloc && alloc->allocate)
-            data_ = alloc->allocate(bytes);
+    if (capacity_ > 0) {
+        if (alloc && alloc->allocateFast)
+            data_ = alloc->allocateFast(alloc->ctx, capacity_);
+        else if (alloc && alloc->allocate)
+            data_ = alloc->allocate(capacity_);
         else
-            data_ = ::operator new(bytes);
+            data_ = ::operator new(capacity_);
         if (!data_)
             throw std::bad_alloc();
     }
@@ -205,13 +257,23 @@ DataBuffer::DataBuffer(size_t bytes, Allocator *alloc)
 DataBuffer::~DataBuffer()
 {
     if (data_) {
-        if (allocator_ && allocator_->deallocate)
-            allocator_->deallocate(data_, bytes_);
+        if (allocator_ && allocator_->deallocateFast)
+            allocator_->deallocateFast(allocator_->ctx, data_, capacity_);
+        else if (allocator_ && allocator_->deallocate)
+            allocator_->deallocate(data_, capacity_);
         else
             ::operator delete(data_);
     }
 }
 
+bool DataBuffer::growWithin(size_t newBytes)
+{
+    if (newBytes > capacity_)
+        return false;
+    bytes_ = newBytes;
+    return true;
+}
+
 void DataBuffer::addRef()
 {
     refCount_.fetch_add(1, std::memory_order_relaxed);
@@ -237,14 +299,93 @@ void MValue::releaseBuffer()
     }
 }
 
+const void *MValue::payload() const
+{
+    if (inline_)
+        return small_;
+    if (!buffer_)
+        return nullptr;
+    return static_cast<const char *>(buffer_->data()) + elemOffset_ * elementSize(type_);
+}
+
+void *MValue::payloadMut()
+{
+    if (inline_)
+        return small_;
+    if (!buffer_)
+        return nullptr;
+    return static_cast<char *>(buffer_->data()) + elemOffset_ * elementSize(type_);
+}
+
+void MValue::releaseContainers()
+{
+    if (stringData_) {
+        if (stringData_->refCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            delete stringData_;
+        stringData_ = nullptr;
+    }
+    if (cellData_) {
+        if (cellData_->refCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            delete cellData_;
+        cellData_ = nullptr;
+    }
+    if (structData_) {
+        if (structData_->refCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            delete structData_;
+        structData_ = nullptr;
+    }
+}
+
+MValue::CellData &MValue::cellDataOrCreate()
+{
+    if (!cellData_)
+        cellData_ = new CellData();
+    return *cellData_;
+}
+
+MValue::StructData &MValue::structDataOrCreate()
+{
+    if (!structData_)
+        structData_ = new StructData();
+    return *structData_;
+}
+
+void MValue::detachCell()
+{
+    if (!cellData_ || cellData_->refCount.load(std::memory_order_acquire) <= 1)
+        return;
+    auto *copy = new CellData();
+    copy->items = cellData_->items;
+    if (cellData_->refCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        delete cellData_;
+    cellData_ = copy;
+}
+
+void MValue::detachStruct()
+{
+    if (!structData_ || structData_->refCount.load(std::memory_order_acquire) <= 1)
+        return;
+    auto *copy = new StructData();
+    copy->ids = structData_->ids;
+    copy->vals = structData_->vals;
+    if (structData_->refCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        delete structData_;
+    structData_ = copy;
+}
+
 void MValue::detach()
 {
+    if (inline_)
+        return; // inline payloads are uniquely owned
     if (!buffer_ || buffer_->refCount() <= 1)
         return;
+    // Copy only the viewed region; a full value views its whole buffer.
+    size_t bytes = dims_.numel() * elementSize(type_);
     DataBuffer *oldBuf = buffer_;
-    auto newBuf = std::unique_ptr<DataBuffer>(new DataBuffer(oldBuf->bytes(), allocator_));
-    std::memcpy(newBuf->data(), oldBuf->data(), oldBuf->bytes());
+    auto newBuf = std::unique_ptr<DataBuffer>(new DataBuffer(bytes, allocator_));
+    std::memcpy(newBuf->data(), payload(), bytes);
     buffer_ = newBuf.release();
+    elemOffset_ = 0;
     if (oldBuf->release())
         delete oldBuf;
 }
@@ -256,6 +397,7 @@ MValue::MValue() = default;
 MValue::~MValue()
 {
     releaseBuffer();
+    releaseContainers();
 }
 
 MValue::MValue(const MValue &other)
@@ -265,10 +407,27 @@ MValue::MValue(const MValue &other)
     , allocator_(other.allocator_)
     , cellData_(other.cellData_)
     , structData_(other.structData_)
+    , stringData_(other.stringData_)
     , funcHandleName_(other.funcHandleName_)
 {
+    inline_ = other.inline_;
+    std::memcpy(small_, other.small_, sizeof(small_));
+    range_ = other.range_;
+    rangeStart_ = other.rangeStart_;
+    rangeStep_ = other.rangeStep_;
+    rangeStop_ = other.rangeStop_;
+    elemOffset_ = other.elemOffset_;
+    handleOwner_ = other.handleOwner_;
+    handleBuiltinId_ = other.handleBuiltinId_;
+    handleUserFunc_ = other.handleUserFunc_;
     if (buffer_)
         buffer_->addRef();
+    if (cellData_)
+        cellData_->refCount.fetch_add(1, std::memory_order_relaxed);
+    if (structData_)
+        structData_->refCount.fetch_add(1, std::memory_order_relaxed);
+    if (stringData_)
+        stringData_->refCount.fetch_add(1, std::memory_order_relaxed);
 }
 
 MValue &MValue::operator=(const MValue &other)
@@ -285,13 +444,30 @@ MValue::MValue(MValue &&other)
     , dims_(other.dims_)
     , buffer_(other.buffer_)
     , allocator_(other.allocator_)
-    , cellData_(std::move(other.cellData_))
-    , structData_(std::move(other.structData_))
+    , cellData_(other.cellData_)
+    , structData_(other.structData_)
+    , stringData_(other.stringData_)
     , funcHandleName_(std::move(other.funcHandleName_))
 {
+    inline_ = other.inline_;
+    std::memcpy(small_, other.small_, sizeof(small_));
+    range_ = other.range_;
+    rangeStart_ = other.rangeStart_;
+    rangeStep_ = other.rangeStep_;
+    rangeStop_ = other.rangeStop_;
+    elemOffset_ = other.elemOffset_;
+    other.elemOffset_ = 0;
+    handleOwner_ = other.handleOwner_;
+    handleBuiltinId_ = other.handleBuiltinId_;
+    handleUserFunc_ = other.handleUserFunc_;
+    other.range_ = false;
     other.buffer_ = nullptr;
+    other.cellData_ = nullptr;
+    other.structData_ = nullptr;
+    other.stringData_ = nullptr;
     other.type_ = MType::EMPTY;
     other.dims_ = Dims();
+    other.inline_ = false;
 }
 
 MValue &MValue::operator=(MValue &&other)
@@ -309,8 +485,19 @@ void MValue::swap(MValue &other) noexcept
     std::swap(dims_, other.dims_);
     std::swap(buffer_, other.buffer_);
     std::swap(allocator_, other.allocator_);
-    cellData_.swap(other.cellData_);
-    structData_.swap(other.structData_);
+    std::swap(inline_, other.inline_);
+    std::swap_ranges(small_, small_ + sizeof(small_), other.small_);
+    std::swap(range_, other.range_);
+    std::swap(rangeStart_, other.rangeStart_);
+    std::swap(rangeStep_, other.rangeStep_);
+    std::swap(rangeStop_, other.rangeStop_);
+    std::swap(elemOffset_, other.elemOffset_);
+    std::swap(handleOwner_, other.handleOwner_);
+    std::swap(handleBuiltinId_, other.handleBuiltinId_);
+    std::swap(handleUserFunc_, other.handleUserFunc_);
+    std::swap(cellData_, other.cellData_);
+    std::swap(structData_, other.structData_);
+    std::swap(stringData_, other.stringData_);
     funcHandleName_.swap(other.funcHandleName_);
 }
 
@@ -323,8 +510,8 @@ MValue MValue::scalar(double v, Allocator *alloc)
     m.type_ = MType::DOUBLE;
     m.dims_ = {1, 1};
     m.allocator_ = alloc;
-    m.buffer_ = new DataBuffer(sizeof(double), alloc);
-    *static_cast<double *>(m.buffer_->data()) = v;
+    m.inline_ = true;
+    *reinterpret_cast<double *>(m.small_) = v;
     return m;
 }
 
@@ -334,8 +521,8 @@ MValue MValue::logicalScalar(bool v, Allocator *alloc)
     m.type_ = MType::LOGICAL;
     m.dims_ = {1, 1};
     m.allocator_ = alloc;
-    m.buffer_ = new DataBuffer(sizeof(uint8_t), alloc);
-    *static_cast<uint8_t *>(m.buffer_->data()) = v ? 1 : 0;
+    m.inline_ = true;
+    *reinterpret_cast<uint8_t *>(m.small_) = v ? 1 : 0;
     return m;
 }
 
@@ -380,12 +567,90 @@ MValue MValue::fromString(const std::string &s, Allocator *alloc)
     return m;
 }
 
+MValue MValue::range(double start, double step, double stop, size_t count, Allocator *alloc)
+{
+    MValue m;
+    m.type_ = MType::DOUBLE;
+    m.dims_ = {1, count};
+    m.allocator_ = alloc;
+    m.range_ = true;
+    m.rangeStart_ = start;
+    m.rangeStep_ = step;
+    m.rangeStop_ = stop;
+    return m;
+}
+
+double MValue::rangeElem(size_t i) const
+{
+    double v = rangeStart_ + static_cast<double>(i) * rangeStep_;
+    if (i + 1 == numel() && numel() >= 2) {
+        if (rangeStep_ > 0 && v > rangeStop_)
+            return rangeStop_;
+        if (rangeStep_ < 0 && v < rangeStop_)
+            return rangeStop_;
+    }
+    return v;
+}
+
+void MValue::materializeRange() const
+{
+    if (!range_)
+        return;
+    auto *self = const_cast<MValue *>(this);
+    size_t n = numel();
+    if (n == 1) {
+        self->inline_ = true;
+        *reinterpret_cast<double *>(self->small_) = rangeElem(0);
+    } else if (n > 0) {
+        self->buffer_ = new DataBuffer(n * sizeof(double), allocator_);
+        double *dst = static_cast<double *>(self->buffer_->data());
+        for (size_t i = 0; i < n; ++i)
+            dst[i] = rangeElem(i);
+    }
+    self->range_ = false;
+}
+
+MValue MValue::view(const MValue &src, size_t elemOffset, size_t rows, size_t cols)
+{
+    size_t es = elementSize(src.type_);
+    if (es == 0 || src.inline_ || src.range_ || !src.buffer_)
+        throw std::runtime_error("Cannot create a view of this value");
+    MValue m;
+    m.type_ = src.type_;
+    m.dims_ = {rows, cols};
+    m.allocator_ = src.allocator_;
+    m.buffer_ = src.buffer_;
+    m.buffer_->addRef();
+    m.elemOffset_ = src.elemOffset_ + elemOffset;
+    return m;
+}
+
 MValue MValue::cell(size_t rows, size_t cols)
 {
     MValue m;
     m.type_ = MType::CELL;
     m.dims_ = {rows, cols};
-    m.cellData_.resize(rows * cols);
+    m.cellDataOrCreate().items.resize(rows * cols);
+    return m;
+}
+
+MValue MValue::stringArray(std::vector<std::string> items)
+{
+    MValue m;
+    m.type_ = MType::STRING;
+    m.dims_ = {1, items.size()};
+    auto *sd = new StringData();
+    size_t total = 0;
+    for (auto &s : items)
+        total += s.size();
+    sd->chars.reserve(total);
+    sd->offsets.reserve(items.size() + 1);
+    sd->offsets.push_back(0);
+    for (auto &s : items) {
+        sd->chars += s;
+        sd->offsets.push_back(sd->chars.size());
+    }
+    m.stringData_ = sd;
     return m;
 }
 
@@ -421,8 +686,8 @@ MValue MValue::complexScalar(Complex v, Allocator *alloc)
     m.type_ = MType::COMPLEX;
     m.dims_ = {1, 1};
     m.allocator_ = alloc;
-    m.buffer_ = new DataBuffer(sizeof(Complex), alloc);
-    *static_cast<Complex *>(m.buffer_->data()) = v;
+    m.inline_ = true;
+    *reinterpret_cast<Complex *>(m.small_) = v;
     return m;
 }
 
@@ -499,17 +764,43 @@ bool MValue::isFuncHandle() const
 {
     return type_ == MType::FUNC_HANDLE;
 }
+bool MValue::isStringArray() const
+{
+    return type_ == MType::STRING;
+}
+bool MValue::isRange() const
+{
+    return range_;
+}
+bool MValue::isView() const
+{
+    return elemOffset_ != 0
+           || (buffer_ && buffer_->bytes() != dims_.numel() * elementSize(type_));
+}
 
 // ============================================================
 // Const data access — raw
 // ============================================================
+int MValue::bufferRefCount() const
+{
+    if (inline_)
+        return 1;
+    return buffer_ ? buffer_->refCount() : 0;
+}
+
 const void *MValue::rawData() const
 {
-    return buffer_ ? buffer_->data() : nullptr;
+    materializeRange();
+    return payload();
 }
 size_t MValue::rawBytes() const
 {
-    return buffer_ ? buffer_->bytes() : 0;
+    materializeRange();
+    if (inline_)
+        return elementSize(type_);
+    if (!buffer_)
+        return 0;
+    return dims_.numel() * elementSize(type_);
 }
 
 // ============================================================
@@ -519,14 +810,15 @@ const double *MValue::doubleData() const
 {
     if (type_ != MType::DOUBLE)
         throw std::runtime_error("Not a double array");
-    return buffer_ ? static_cast<const double *>(buffer_->data()) : nullptr;
+    materializeRange();
+    return static_cast<const double *>(payload());
 }
 
 const uint8_t *MValue::logicalData() const
 {
     if (type_ != MType::LOGICAL)
         throw std::runtime_error("Not a logical array");
-    return buffer_ ? static_cast<const uint8_t *>(buffer_->data()) : nullptr;
+    return static_cast<const uint8_t *>(payload());
 }
 
 const char *MValue::charData() const
@@ -538,57 +830,132 @@ const char *MValue::charData() const
 
 double MValue::toScalar() const
 {
-    if (type_ == MType::DOUBLE && isScalar() && buffer_)
-        return *static_cast<const double *>(buffer_->data());
-    if (type_ == MType::COMPLEX && isScalar() && buffer_) {
-        auto c = *static_cast<const Complex *>(buffer_->data());
+    if (range_ && isScalar())
+        return rangeElem(0);
+    if (type_ == MType::DOUBLE && isScalar() && hasData())
+        return *static_cast<const double *>(payload());
+    if (type_ == MType::COMPLEX && isScalar() && hasData()) {
+        auto c = *static_cast<const Complex *>(payload());
         if (c.imag() != 0.0)
             throw std::runtime_error(
                 "Cannot convert complex with nonzero imaginary part to double scalar");
         return c.real();
     }
-    if (type_ == MType::LOGICAL && isScalar() && buffer_)
-        return static_cast<double>(*static_cast<const uint8_t *>(buffer_->data()));
+    if (type_ == MType::LOGICAL && isScalar() && hasData())
+        return static_cast<double>(*static_cast<const uint8_t *>(payload()));
     if (type_ == MType::CHAR && isScalar() && buffer_)
         return static_cast<double>(
             static_cast<unsigned char>(*static_cast<const char *>(buffer_->data())));
+    if (isIntegerType(type_) && isScalar() && hasData()) {
+        switch (type_) {
+        case MType::INT8:
+            return static_cast<double>(*static_cast<const int8_t *>(payload()));
+        case MType::INT16:
+            return static_cast<double>(*static_cast<const int16_t *>(payload()));
+        case MType::INT32:
+            return static_cast<double>(*static_cast<const int32_t *>(payload()));
+        case MType::INT64:
+            return static_cast<double>(*static_cast<const int64_t *>(payload()));
+        case MType::UINT8:
+            return static_cast<double>(*static_cast<const uint8_t *>(payload()));
+        case MType::UINT16:
+            return static_cast<double>(*static_cast<const uint16_t *>(payload()));
+        case MType::UINT32:
+            return static_cast<double>(*static_cast<const uint32_t *>(payload()));
+        case MType::UINT64:
+            return static_cast<double>(*static_cast<const uint64_t *>(payload()));
+        default:
+            break;
+        }
+    }
     throw std::runtime_error("Cannot convert " + std::string(mtypeName(type_)) + " to scalar");
 }
 
 bool MValue::toBool() const
 {
-    if (type_ == MType::LOGICAL && isScalar() && buffer_)
-        return *static_cast<const uint8_t *>(buffer_->data()) != 0;
-    if (type_ == MType::DOUBLE && isScalar() && buffer_)
-        return *static_cast<const double *>(buffer_->data()) != 0.0;
-    if (type_ == MType::COMPLEX && isScalar() && buffer_) {
-        auto c = *static_cast<const Complex *>(buffer_->data());
+    if (range_ && isScalar())
+        return rangeElem(0) != 0.0;
+    if (type_ == MType::LOGICAL && isScalar() && hasData())
+        return *static_cast<const uint8_t *>(payload()) != 0;
+    if (type_ == MType::DOUBLE && isScalar() && hasData())
+        return *static_cast<const double *>(payload()) != 0.0;
+    if (type_ == MType::COMPLEX && isScalar() && hasData()) {
+        auto c = *static_cast<const Complex *>(payload());
         return c.real() != 0.0 || c.imag() != 0.0;
     }
-    if (type_ == MType::DOUBLE && buffer_) {
+    if (type_ == MType::DOUBLE && (buffer_ || range_)) {
         const double *dd = doubleData();
         for (size_t i = 0; i < numel(); ++i)
             if (dd[i] == 0.0)
                 return false;
         return numel() > 0;
     }
+    if (isIntegerType(type_) && isScalar() && hasData())
+        return toScalar() != 0.0;
     throw std::runtime_error("Cannot convert " + std::string(mtypeName(type_)) + " to bool");
 }
 
 std::string MValue::toString() const
 {
-    if (type_ == MType::CHAR && buffer_)
-        return std::string(static_cast<const char *>(buffer_->data()), dims_.numel());
+    if (type_ == MType::CHAR)
+        return buffer_ ? std::string(static_cast<const char *>(buffer_->data()), dims_.numel())
+                       : std::string();
     if (type_ == MType::FUNC_HANDLE)
         return funcHandleName_;
     throw std::runtime_error("Not a char array");
 }
 
+std::string_view MValue::stringAt(size_t i) const
+{
+    if (type_ != MType::STRING || !stringData_ || i + 1 >= stringData_->offsets.size())
+        throw std::runtime_error("String index out of bounds");
+    size_t lo = stringData_->offsets[i];
+    size_t hi = stringData_->offsets[i + 1];
+    return std::string_view(stringData_->chars.data() + lo, hi - lo);
+}
+
+size_t MValue::stringBytes() const
+{
+    return stringData_ ? stringData_->chars.size() : 0;
+}
+
+std::string_view MValue::pooledChars() const
+{
+    if (!stringData_)
+        return {};
+    return std::string_view(stringData_->chars.data(), stringData_->chars.size());
+}
+
+const std::vector<size_t> &MValue::stringOffsets() const
+{
+    static const std::vector<size_t> kEmpty = {0};
+    return stringData_ ? stringData_->offsets : kEmpty;
+}
+
+MValue MValue::stringArrayFromPool(std::string chars, std::vector<size_t> offsets)
+{
+    MValue m;
+    m.type_ = MType::STRING;
+    m.dims_ = {1, offsets.empty() ? 0 : offsets.size() - 1};
+    auto *sd = new StringData();
+    sd->chars = std::move(chars);
+    sd->offsets = std::move(offsets);
+    m.stringData_ = sd;
+    return m;
+}
+
 std::string MValue::funcHandleName() const
 {
     return funcHandleName_;
 }
 
+void MValue::bindHandleTarget(const void *owner, int builtinId, const void *userFunc)
+{
+    handleOwner_ = owner;
+    handleBuiltinId_ = builtinId;
+    handleUserFunc_ = userFunc;
+}
+
 // ============================================================
 // Const data access — complex
 // ============================================================
@@ -596,17 +963,19 @@ const Complex *MValue::complexData() const
 {
     if (type_ != MType::COMPLEX)
         throw std::runtime_error("Not a complex array");
-    return buffer_ ? static_cast<const Complex *>(buffer_->data()) : nullptr;
+    return static_cast<const Complex *>(payload());
 }
 
 Complex MValue::toComplex() const
 {
-    if (type_ == MType::COMPLEX && isScalar() && buffer_)
-        return *static_cast<const Complex *>(buffer_->data());
-    if (type_ == MType::DOUBLE && isScalar() && buffer_)
-        return Complex(*static_cast<const double *>(buffer_->data()), 0.0);
-    if (type_ == MType::LOGICAL && isScalar() && buffer_)
-        return Complex(static_cast<double>(*static_cast<const uint8_t *>(buffer_->data())), 0.0);
+    if (range_ && isScalar())
+        return Complex(rangeElem(0), 0.0);
+    if (type_ == MType::COMPLEX && isScalar() && hasData())
+        return *static_cast<const Complex *>(payload());
+    if (type_ == MType::DOUBLE && isScalar() && hasData())
+        return Complex(*static_cast<const double *>(payload()), 0.0);
+    if (type_ == MType::LOGICAL && isScalar() && hasData())
+        return Complex(static_cast<double>(*static_cast<const uint8_t *>(payload())), 0.0);
     throw std::runtime_error("Cannot convert " + std::string(mtypeName(type_)) + " to complex");
 }
 
@@ -629,8 +998,9 @@ double *MValue::doubleDataMut()
 {
     if (type_ != MType::DOUBLE)
         throw std::runtime_error("Not a double array");
+    materializeRange();
     detach();
-    return buffer_ ? static_cast<double *>(buffer_->data()) : nullptr;
+    return static_cast<double *>(payloadMut());
 }
 
 uint8_t *MValue::logicalDataMut()
@@ -638,7 +1008,7 @@ uint8_t *MValue::logicalDataMut()
     if (type_ != MType::LOGICAL)
         throw std::runtime_error("Not a logical array");
     detach();
-    return buffer_ ? static_cast<uint8_t *>(buffer_->data()) : nullptr;
+    return static_cast<uint8_t *>(payloadMut());
 }
 
 char *MValue::charDataMut()
@@ -651,8 +1021,9 @@ char *MValue::charDataMut()
 
 void *MValue::rawDataMut()
 {
+    materializeRange();
     detach();
-    return buffer_ ? buffer_->data() : nullptr;
+    return payloadMut();
 }
 
 Complex *MValue::complexDataMut()
@@ -660,7 +1031,7 @@ Complex *MValue::complexDataMut()
     if (type_ != MType::COMPLEX)
         throw std::runtime_error("Not a complex array");
     detach();
-    return buffer_ ? static_cast<Complex *>(buffer_->data()) : nullptr;
+    return static_cast<Complex *>(payloadMut());
 }
 
 // ============================================================
@@ -668,6 +1039,7 @@ Complex *MValue::complexDataMut()
 // ============================================================
 void MValue::promoteToComplex(Allocator *alloc)
 {
+    materializeRange();
     if (type_ == MType::COMPLEX)
         return;
     if (type_ != MType::DOUBLE)
@@ -675,12 +1047,20 @@ void MValue::promoteToComplex(Allocator *alloc)
     if (!alloc)
         alloc = allocator_;
 
+    if (inline_) {
+        // Scalar double stays inline as a scalar complex.
+        double v = *reinterpret_cast<const double *>(small_);
+        *reinterpret_cast<Complex *>(small_) = Complex(v, 0.0);
+        type_ = MType::COMPLEX;
+        return;
+    }
+
     size_t n = numel();
     auto newBuf = std::unique_ptr<DataBuffer>(new DataBuffer(n * sizeof(Complex), alloc));
     Complex *dst = static_cast<Complex *>(newBuf->data());
 
     if (buffer_ && n > 0) {
-        const double *src = static_cast<const double *>(buffer_->data());
+        const double *src = static_cast<const double *>(payload());
         for (size_t i = 0; i < n; ++i)
             dst[i] = Complex(src[i], 0.0);
     } else {
@@ -689,6 +1069,7 @@ void MValue::promoteToComplex(Allocator *alloc)
 
     releaseBuffer();
     buffer_ = newBuf.release();
+    elemOffset_ = 0;
     allocator_ = alloc;
     type_ = MType::COMPLEX;
 }
@@ -701,14 +1082,20 @@ double MValue::operator()(size_t i) const
     if (i >= numel())
         throw std::runtime_error("Linear index " + std::to_string(i + 1) + " exceeds array size "
                                  + std::to_string(numel()));
+    if (range_)
+        return rangeElem(i);
     return doubleData()[i];
 }
 double MValue::operator()(size_t r, size_t c) const
 {
+    if (range_)
+        return rangeElem(dims_.sub2indChecked(r, c));
     return doubleData()[dims_.sub2indChecked(r, c)];
 }
 double MValue::operator()(size_t r, size_t c, size_t p) const
 {
+    if (range_)
+        return rangeElem(dims_.sub2indChecked(r, c, p));
     return doubleData()[dims_.sub2indChecked(r, c, p)];
 }
 
@@ -749,6 +1136,7 @@ char &MValue::charElemMut(size_t i)
 // ============================================================
 void MValue::resize(size_t newRows, size_t newCols, Allocator *alloc)
 {
+    materializeRange();
     if (dims_.is3D()) {
         resize3d(newRows, newCols, dims_.pages(), alloc);
         return;
@@ -760,27 +1148,48 @@ void MValue::resize(size_t newRows, size_t newCols, Allocator *alloc)
     size_t es = elementSize(type_);
     size_t newBytes = newRows * newCols * es;
 
+    // Vector extension (the A(end+1) = x append pattern): the layout
+    // stays contiguous, so a uniquely-owned buffer grows within its
+    // capacity — or reallocates with geometric headroom — instead of
+    // copying the whole array every time.
+    bool vectorExtend = buffer_ && !inline_ && !isView() && buffer_->refCount() == 1 && es > 0
+                        && ((oldRows == 1 && newRows == 1 && newCols >= oldCols)
+                            || (oldCols == 1 && newCols == 1 && newRows >= oldRows));
+    if (vectorExtend) {
+        size_t oldBytes = buffer_->bytes();
+        if (buffer_->growWithin(newBytes)) {
+            std::memset(static_cast<char *>(buffer_->data()) + oldBytes, 0, newBytes - oldBytes);
+            dims_ = {newRows, newCols};
+            return;
+        }
+        size_t headroom = std::max(newBytes, oldBytes * 2);
+        auto newBuf = std::unique_ptr<DataBuffer>(new DataBuffer(newBytes, alloc, headroom));
+        std::memcpy(newBuf->data(), buffer_->data(), oldBytes);
+        std::memset(static_cast<char *>(newBuf->data()) + oldBytes, 0, newBytes - oldBytes);
+        releaseBuffer();
+        buffer_ = newBuf.release();
+        elemOffset_ = 0;
+        allocator_ = alloc;
+        dims_ = {newRows, newCols};
+        return;
+    }
+
     auto newBuf = std::unique_ptr<DataBuffer>(new DataBuffer(newBytes, alloc));
     if (newBytes > 0)
         std::memset(newBuf->data(), 0, newBytes);
 
-    if (buffer_ && es > 0) {
+    if (hasData() && es > 0) {
         size_t copyRows = std::min(oldRows, newRows);
         size_t copyCols = std::min(oldCols, newCols);
-        if (type_ == MType::DOUBLE || type_ == MType::COMPLEX) {
-            const char *src = static_cast<const char *>(buffer_->data());
-            char *dst = static_cast<char *>(newBuf->data());
-            for (size_t c = 0; c < copyCols; ++c)
-                std::memcpy(dst + c * newRows * es, src + c * oldRows * es, copyRows * es);
-        } else {
-            const char *src = static_cast<const char *>(buffer_->data());
-            char *dst = static_cast<char *>(newBuf->data());
-            for (size_t c = 0; c < copyCols; ++c)
-                std::memcpy(dst + c * newRows * es, src + c * oldRows * es, copyRows * es);
-        }
+        const char *src = static_cast<const char *>(payload());
+        char *dst = static_cast<char *>(newBuf->data());
+        for (size_t c = 0; c < copyCols; ++c)
+            std::memcpy(dst + c * newRows * es, src + c * oldRows * es, copyRows * es);
     }
 
     releaseBuffer();
+    inline_ = false;
+    elemOffset_ = 0;
     buffer_ = newBuf.release();
     allocator_ = alloc;
     dims_ = {newRows, newCols};
@@ -791,6 +1200,7 @@ void MValue::resize(size_t newRows, size_t newCols, Allocator *alloc)
 // ============================================================
 void MValue::resize3d(size_t newRows, size_t newCols, size_t newPages, Allocator *alloc)
 {
+    materializeRange();
     if (newPages <= 1) {
         dims_.nd = 2;
         resize(newRows, newCols, alloc);
@@ -810,7 +1220,7 @@ void MValue::resize3d(size_t newRows, size_t newCols, size_t newPages, Allocator
     if (newBytes > 0)
         std::memset(newBuf->data(), 0, newBytes);
 
-    if (buffer_ && es > 0) {
+    if (hasData() && es > 0) {
         size_t copyRows = std::min(oldRows, newRows);
         size_t copyCols = std::min(oldCols, newCols);
         size_t copyPages = std::min(oldPages, newPages);
@@ -818,7 +1228,7 @@ void MValue::resize3d(size_t newRows, size_t newCols, size_t newPages, Allocator
         size_t oldPageStride = oldRows * oldCols;
         size_t newPageStride = newRows * newCols;
 
-        const char *src = static_cast<const char *>(buffer_->data());
+        const char *src = static_cast<const char *>(payload());
         char *dst = static_cast<char *>(newBuf->data());
         for (size_t p = 0; p < copyPages; ++p)
             for (size_t c = 0; c < copyCols; ++c)
@@ -828,6 +1238,8 @@ void MValue::resize3d(size_t newRows, size_t newCols, size_t newPages, Allocator
     }
 
     releaseBuffer();
+    inline_ = false;
+    elemOffset_ = 0;
     buffer_ = newBuf.release();
     allocator_ = alloc;
     dims_ = {newRows, newCols, newPages};
@@ -843,8 +1255,8 @@ void MValue::ensureSize(size_t linearIdx, Allocator *alloc)
         dims_ = {1, 1};
         if (!alloc)
             alloc = allocator_;
-        buffer_ = new DataBuffer(sizeof(double), alloc);
-        std::memset(buffer_->data(), 0, sizeof(double));
+        inline_ = true;
+        *reinterpret_cast<double *>(small_) = 0.0;
         allocator_ = alloc;
     }
     size_t needed = linearIdx + 1;
@@ -865,60 +1277,123 @@ MValue &MValue::cellAt(size_t i)
 {
     if (type_ != MType::CELL)
         throw std::runtime_error("Not a cell");
-    if (i >= cellData_.size())
+    detachCell();
+    auto &items = cellDataOrCreate().items;
+    if (i >= items.size())
         throw std::runtime_error("Cell index out of bounds");
-    return cellData_[i];
+    return items[i];
 }
 
 const MValue &MValue::cellAt(size_t i) const
 {
     if (type_ != MType::CELL)
         throw std::runtime_error("Not a cell");
-    if (i >= cellData_.size())
+    if (!cellData_ || i >= cellData_->items.size())
         throw std::runtime_error("Cell index out of bounds");
-    return cellData_[i];
+    return cellData_->items[i];
 }
 
 std::vector<MValue> &MValue::cellDataVec()
 {
-    return cellData_;
+    detachCell();
+    return cellDataOrCreate().items;
 }
 const std::vector<MValue> &MValue::cellDataVec() const
 {
-    return cellData_;
+    static const std::vector<MValue> kEmpty;
+    return cellData_ ? cellData_->items : kEmpty;
 }
 
 // ============================================================
 // Struct
 // ============================================================
 MValue &MValue::field(const std::string &name)
+{
+    return fieldById(internFieldName(name));
+}
+
+const MValue &MValue::field(const std::string &name) const
 {
     if (type_ != MType::STRUCT)
         throw std::runtime_error("Not a struct");
-    return structData_[name];
+    if (const MValue *v = findFieldById(internFieldName(name)))
+        return *v;
+    throw std::runtime_error("Field not found: " + name);
 }
 
-const MValue &MValue::field(const std::string &name) const
+MValue &MValue::fieldById(uint32_t id)
 {
     if (type_ != MType::STRUCT)
         throw std::runtime_error("Not a struct");
-    auto it = structData_.find(name);
-    if (it == structData_.end())
-        throw std::runtime_error("Field not found: " + name);
-    return it->second;
+    detachStruct();
+    auto &sd = structDataOrCreate();
+    for (size_t i = 0; i < sd.ids.size(); ++i)
+        if (sd.ids[i] == id)
+            return sd.vals[i];
+    sd.ids.push_back(id);
+    sd.vals.emplace_back();
+    return sd.vals.back();
+}
+
+const MValue *MValue::findFieldById(uint32_t id) const
+{
+    if (type_ != MType::STRUCT || !structData_)
+        return nullptr;
+    for (size_t i = 0; i < structData_->ids.size(); ++i)
+        if (structData_->ids[i] == id)
+            return &structData_->vals[i];
+    return nullptr;
 }
 
 bool MValue::hasField(const std::string &name) const
 {
-    return structData_.count(name) > 0;
+    return findFieldById(internFieldName(name)) != nullptr;
 }
-std::map<std::string, MValue> &MValue::structFields()
+
+size_t MValue::fieldCount() const
+{
+    return structData_ ? structData_->ids.size() : 0;
+}
+
+const std::string &MValue::fieldNameAt(size_t i) const
+{
+    if (!structData_ || i >= structData_->ids.size())
+        throw std::runtime_error("Field index out of bounds");
+    return fieldNameById(structData_->ids[i]);
+}
+
+MValue &MValue::fieldAt(size_t i)
+{
+    if (type_ != MType::STRUCT)
+        throw std::runtime_error("Not a struct");
+    detachStruct();
+    if (!structData_ || i >= structData_->vals.size())
+        throw std::runtime_error("Field index out of bounds");
+    return structData_->vals[i];
+}
+
+const MValue &MValue::fieldAt(size_t i) const
 {
-    return structData_;
+    if (!structData_ || i >= structData_->vals.size())
+        throw std::runtime_error("Field index out of bounds");
+    return structData_->vals[i];
 }
-const std::map<std::string, MValue> &MValue::structFields() const
+
+bool MValue::removeField(const std::string &name)
 {
-    return structData_;
+    if (type_ != MType::STRUCT || !structData_)
+        return false;
+    uint32_t id = internFieldName(name);
+    detachStruct();
+    auto &sd = *structData_;
+    for (size_t i = 0; i < sd.ids.size(); ++i) {
+        if (sd.ids[i] == id) {
+            sd.ids.erase(sd.ids.begin() + i);
+            sd.vals.erase(sd.vals.begin() + i);
+            return true;
+        }
+    }
+    return false;
 }
 
 // ============================================================
@@ -931,7 +1406,7 @@ std::string MValue::debugString() const
     if (dims_.is3D())
         os << "x" << dims_.pages();
     os << "]";
-    if (type_ == MType::DOUBLE && numel() <= 20 && numel() > 0 && buffer_) {
+    if (type_ == MType::DOUBLE && numel() <= 20 && numel() > 0 && (hasData() || range_)) {
         os << " = ";
         const double *dd = doubleData();
         if (isScalar()) {
@@ -946,7 +1421,7 @@ std::string MValue::debugString() const
             os << "]";
         }
     }
-    if (type_ == MType::COMPLEX && numel() <= 20 && numel() > 0 && buffer_) {
+    if (type_ == MType::COMPLEX && numel() <= 20 && numel() > 0 && hasData()) {
         os << " = ";
         const Complex *cd = complexData();
         if (isScalar()) {
@@ -967,7 +1442,7 @@ std::string MValue::debugString() const
             os << "]";
         }
     }
-    if (type_ == MType::LOGICAL && numel() <= 20 && numel() > 0 && buffer_) {
+    if (type_ == MType::LOGICAL && numel() <= 20 && numel() > 0 && hasData()) {
         os << " = ";
         const uint8_t *ld = logicalData();
         if (isScalar()) {
@@ -986,14 +1461,27 @@ std::string MValue::debugString() const
         os << " = '" << toString() << "'";
     if (type_ == MType::FUNC_HANDLE)
         os << " = @" << funcHandleName_;
+    if (type_ == MType::STRING && stringData_) {
+        os << " [";
+        size_t count = stringData_->offsets.size() - 1;
+        for (size_t i = 0; i < count && i < 10; ++i) {
+            if (i)
+                os << ", ";
+            os << '"' << std::string(stringAt(i)) << '"';
+        }
+        if (count > 10)
+            os << ", ...";
+        os << "]";
+    }
     if (type_ == MType::CELL) {
+        const auto &items = cellDataVec();
         os << " {";
-        for (size_t i = 0; i < cellData_.size() && i < 10; ++i) {
+        for (size_t i = 0; i < items.size() && i < 10; ++i) {
             if (i)
                 os << ", ";
-            os << cellData_[i].debugString();
+            os << items[i].debugString();
         }
-        if (cellData_.size() > 10)
+        if (items.size() > 10)
             os << ", ...";
         os << "}";
     }
@@ -0,0 +1,164 @@
+// tests/bytecode_test.cpp — Тесты для bytecode VM backend
+// Проверяют, что BYTECODE-режим даёт те же результаты, что tree walker,
+// и что неподдерживаемые конструкции корректно падают обратно на него.
+
+#include "MLabEngine.hpp"
+#include "MLabStdLibrary.hpp"
+#include <gtest/gtest.h>
+#include <string>
+
+using namespace mlab;
+
+class BytecodeTest : public ::testing::Test
+{
+public:
+    Engine engine;
+    std::string capturedOutput;
+
+    void SetUp() override
+    {
+        StdLibrary::install(engine);
+        engine.setExecutionMode(ExecutionMode::BYTECODE);
+        capturedOutput.clear();
+        engine.setOutputFunc([this](const std::string &s) { capturedOutput += s; });
+    }
+
+    MValue eval(const std::string &code) { return engine.eval(code); }
+
+    double evalScalar(const std::string &code) { return eval(code).toScalar(); }
+
+    double getVar(const std::string &name) { return engine.getVariable(name)->toScalar(); }
+};
+
+TEST_F(BytecodeTest, ScalarArithmetic)
+{
+    EXPECT_DOUBLE_EQ(evalScalar("2 + 3 * 4;"), 14.0);
+    EXPECT_DOUBLE_EQ(evalScalar("(2 + 3) * 4;"), 20.0);
+    EXPECT_DOUBLE_EQ(evalScalar("-5 + 2;"), -3.0);
+    EXPECT_DOUBLE_EQ(evalScalar("2 ^ 10;"), 1024.0);
+}
+
+TEST_F(BytecodeTest, Assignment)
+{
+    eval("x = 7;");
+    EXPECT_DOUBLE_EQ(getVar("x"), 7.0);
+    eval("y = x * 2;");
+    EXPECT_DOUBLE_EQ(getVar("y"), 14.0);
+}
+
+TEST_F(BytecodeTest, WhileLoop)
+{
+    eval("n = 0; while n < 100 n = n + 1; end");
+    EXPECT_DOUBLE_EQ(getVar("n"), 100.0);
+}
+
+TEST_F(BytecodeTest, ForLoopColonRange)
+{
+    eval("s = 0; for i = 1:10 s = s + i; end");
+    EXPECT_DOUBLE_EQ(getVar("s"), 55.0);
+}
+
+TEST_F(BytecodeTest, ForLoopWithStep)
+{
+    eval("s = 0; for i = 10:-2:2 s = s + i; end");
+    EXPECT_DOUBLE_EQ(getVar("s"), 30.0);
+}
+
+TEST_F(BytecodeTest, ForLoopEmptyRange)
+{
+    eval("s = 0; for i = 5:1 s = s + 1; end");
+    EXPECT_DOUBLE_EQ(getVar("s"), 0.0);
+}
+
+TEST_F(BytecodeTest, NestedLoops)
+{
+    eval("c = 0; for i = 1:5 for j = 1:4 c = c + 1; end end");
+    EXPECT_DOUBLE_EQ(getVar("c"), 20.0);
+}
+
+TEST_F(BytecodeTest, BreakInLoop)
+{
+    eval("s = 0; for i = 1:100 if i > 5 break; end s = s + i; end");
+    EXPECT_DOUBLE_EQ(getVar("s"), 15.0);
+}
+
+TEST_F(BytecodeTest, ContinueInLoop)
+{
+    eval("s = 0; for i = 1:10 if mod(i, 2) == 0 continue; end s = s + i; end");
+    EXPECT_DOUBLE_EQ(getVar("s"), 25.0);
+}
+
+TEST_F(BytecodeTest, IfElseifElse)
+{
+    eval("x = 5; if x > 10 r = 1; elseif x > 3 r = 2; else r = 3; end");
+    EXPECT_DOUBLE_EQ(getVar("r"), 2.0);
+    eval("x = 1; if x > 10 r = 1; elseif x > 3 r = 2; else r = 3; end");
+    EXPECT_DOUBLE_EQ(getVar("r"), 3.0);
+}
+
+TEST_F(BytecodeTest, ShortCircuitAnd)
+{
+    eval("a = 0; r = (a ~= 0) && (1 / a > 0);");
+    EXPECT_FALSE(engine.getVariable("r")->toBool());
+    eval("r2 = true && 5;");
+    EXPECT_TRUE(engine.getVariable("r2")->toBool());
+}
+
+TEST_F(BytecodeTest, ShortCircuitOr)
+{
+    eval("r = true || undefined_thing;");
+    EXPECT_TRUE(engine.getVariable("r")->toBool());
+    eval("r2 = false || 3;");
+    EXPECT_TRUE(engine.getVariable("r2")->toBool());
+}
+
+TEST_F(BytecodeTest, DisplayMatchesTreeWalker)
+{
+    eval("x = 42");
+    std::string bytecodeOutput = capturedOutput;
+
+    Engine tw;
+    StdLibrary::install(tw);
+    std::string twOutput;
+    tw.setOutputFunc([&twOutput](const std::string &s) { twOutput += s; });
+    tw.eval("x = 42");
+
+    EXPECT_EQ(bytecodeOutput, twOutput);
+}
+
+TEST_F(BytecodeTest, FallbackForMatrixCode)
+{
+    // Matrix literals and indexing are not covered by the VM yet;
+    // the script must still run via the tree walker.
+    eval("A = [1 2 3; 4 5 6]; v = A(2, 3);");
+    EXPECT_DOUBLE_EQ(getVar("v"), 6.0);
+}
+
+TEST_F(BytecodeTest, FallbackForFunctionCalls)
+{
+    eval("y = sin(0);");
+    EXPECT_DOUBLE_EQ(getVar("y"), 0.0);
+}
+
+TEST_F(BytecodeTest, MixedSupportedAndFallbackScripts)
+{
+    eval("A = [10 20 30];");        // tree walker
+    eval("k = 2;");                 // VM
+    eval("v = A(k);");              // tree walker
+    eval("w = v * 2 + 1;");         // VM
+    EXPECT_DOUBLE_EQ(getVar("w"), 41.0);
+}
+
+TEST_F(BytecodeTest, AnsIsSetForUnsuppressedExpression)
+{
+    eval("3 + 4");
+    EXPECT_DOUBLE_EQ(getVar("ans"), 7.0);
+}
+
+TEST_F(BytecodeTest, ModeCanBeSwitchedBack)
+{
+    engine.setExecutionMode(ExecutionMode::TREE_WALK);
+    EXPECT_EQ(engine.executionMode(), ExecutionMode::TREE_WALK);
+    eval("z = 1 + 1;");
+    EXPECT_DOUBLE_EQ(getVar("z"), 2.0);
+}
@@ -991,3 +991,1700 @@ TEST_F(EngineGlobalTest, GlobalVariable)
     eval("global g; setg();");
     EXPECT_DOUBLE_EQ(getVar("g"), 42.0);
 }
+
+// ============================================================
+// Compile-once Script API
+// ============================================================
+
+class EngineScriptTest : public EngineTest
+{};
+
+TEST_F(EngineScriptTest, CompileAndRun)
+{
+    auto script = engine.compile("x = 2 + 3;");
+    ASSERT_TRUE(script.valid());
+    engine.run(script);
+    EXPECT_DOUBLE_EQ(getVar("x"), 5.0);
+}
+
+TEST_F(EngineScriptTest, RunScriptRepeatedly)
+{
+    eval("n = 0;");
+    auto script = engine.compile("n = n + 1;");
+    for (int i = 0; i < 10; ++i)
+        engine.run(script);
+    EXPECT_DOUBLE_EQ(getVar("n"), 10.0);
+}
+
+TEST_F(EngineScriptTest, RunEmptyScriptThrows)
+{
+    Script script;
+    EXPECT_FALSE(script.valid());
+    EXPECT_THROW(engine.run(script), std::runtime_error);
+}
+
+TEST_F(EngineScriptTest, CompileSyntaxErrorThrows)
+{
+    EXPECT_THROW(engine.compile("x = (1 + ;"), std::exception);
+}
+
+TEST_F(EngineScriptTest, EvalCacheReusesParsedCode)
+{
+    eval("k = 0;");
+    for (int i = 0; i < 5; ++i)
+        eval("k = k + 1;");
+    EXPECT_DOUBLE_EQ(getVar("k"), 5.0);
+    engine.clearScriptCache();
+    eval("k = k + 1;");
+    EXPECT_DOUBLE_EQ(getVar("k"), 6.0);
+}
+
+TEST_F(EngineScriptTest, ScriptCacheLimitZeroDisablesCache)
+{
+    engine.setScriptCacheLimit(0);
+    eval("y = 1;");
+    eval("y = y + 1;");
+    EXPECT_DOUBLE_EQ(getVar("y"), 2.0);
+}
+
+// ============================================================
+// Variable slot resolution (SlotResolver fast path)
+// ============================================================
+
+class EngineSlotTest : public EngineTest
+{};
+
+TEST_F(EngineSlotTest, TightLoopCounter)
+{
+    eval("x = 0; for i = 1:1000 x = x + 1; end");
+    EXPECT_DOUBLE_EQ(getVar("x"), 1000.0);
+}
+
+TEST_F(EngineSlotTest, ClearThenReassignSameName)
+{
+    eval("v = 5;");
+    eval("clear('v');");
+    eval("v = 9;");
+    EXPECT_DOUBLE_EQ(getVar("v"), 9.0);
+}
+
+TEST_F(EngineSlotTest, FunctionLocalsDoNotLeakToGlobal)
+{
+    eval(R"(
+        function r = addone(x)
+            t = x + 1;
+            r = t;
+        end
+    )");
+    eval("out = addone(4);");
+    EXPECT_DOUBLE_EQ(getVar("out"), 5.0);
+    EXPECT_EQ(engine.getVariable("t"), nullptr);
+}
+
+TEST_F(EngineSlotTest, GlobalDeclarationBypassesSlots)
+{
+    eval(R"(
+        function bump()
+            global counter;
+            counter = counter + 1;
+        end
+    )");
+    eval("global counter; counter = 0;");
+    eval("bump(); bump(); bump();");
+    EXPECT_DOUBLE_EQ(getVar("counter"), 3.0);
+}
+
+TEST_F(EngineSlotTest, RecursionGetsFreshFrames)
+{
+    eval(R"(
+        function r = fact(n)
+            if n <= 1
+                r = 1;
+            else
+                r = n * fact(n - 1);
+            end
+        end
+    )");
+    eval("f = fact(6);");
+    EXPECT_DOUBLE_EQ(getVar("f"), 720.0);
+}
+
+TEST_F(EngineSlotTest, SameNameInTwoScriptsSharesStorage)
+{
+    eval("shared = 1;");
+    eval("shared = shared + 10;");
+    EXPECT_DOUBLE_EQ(getVar("shared"), 11.0);
+}
+
+// ============================================================
+// Elementwise kernel dispatch (MLabKernels)
+// ============================================================
+
+class EngineKernelTest : public EngineTest
+{};
+
+TEST_F(EngineKernelTest, LargeVectorAddMatchesScalarLoop)
+{
+    // 1003 elements: exercises the SIMD main loop plus the tail.
+    eval("a = 1:1003; b = 2 * a; c = a + b;");
+    auto *c = getVarPtr("c");
+    ASSERT_EQ(c->numel(), 1003u);
+    for (size_t i = 0; i < c->numel(); ++i)
+        EXPECT_DOUBLE_EQ(c->doubleData()[i], 3.0 * static_cast<double>(i + 1));
+}
+
+TEST_F(EngineKernelTest, ScalarBroadcastLeftAndRight)
+{
+    eval("v = 1:7; l = 10 - v; r = v - 10;");
+    auto *l = getVarPtr("l");
+    auto *r = getVarPtr("r");
+    for (size_t i = 0; i < 7; ++i) {
+        EXPECT_DOUBLE_EQ(l->doubleData()[i], 10.0 - static_cast<double>(i + 1));
+        EXPECT_DOUBLE_EQ(r->doubleData()[i], static_cast<double>(i + 1) - 10.0);
+    }
+}
+
+TEST_F(EngineKernelTest, ElementwiseDivisionByZeroGivesInf)
+{
+    eval("d = [1 2 3] ./ [1 0 2];");
+    auto *d = getVarPtr("d");
+    EXPECT_DOUBLE_EQ(d->doubleData()[0], 1.0);
+    EXPECT_TRUE(std::isinf(d->doubleData()[1]));
+    EXPECT_DOUBLE_EQ(d->doubleData()[2], 1.5);
+}
+
+TEST_F(EngineKernelTest, ElementwisePower)
+{
+    eval("p = [1 2 3 4] .^ 2;");
+    auto *p = getVarPtr("p");
+    EXPECT_DOUBLE_EQ(p->doubleData()[3], 16.0);
+    eval("q = 2 .^ [0 1 2 3];");
+    auto *q = getVarPtr("q");
+    EXPECT_DOUBLE_EQ(q->doubleData()[3], 8.0);
+}
+
+TEST_F(EngineKernelTest, DimensionMismatchStillThrows)
+{
+    EXPECT_THROW(eval("[1 2 3] + [1 2];"), std::runtime_error);
+}
+
+// ============================================================
+// Matrix multiply kernel (blocked / threaded)
+// ============================================================
+
+class EngineMatmulTest : public EngineTest
+{};
+
+TEST_F(EngineMatmulTest, RectangularProduct)
+{
+    eval("A = [1 2 3; 4 5 6]; B = [7 8; 9 10; 11 12]; C = A * B;");
+    auto *c = getVarPtr("C");
+    ASSERT_EQ(c->dims().rows(), 2u);
+    ASSERT_EQ(c->dims().cols(), 2u);
+    EXPECT_DOUBLE_EQ((*c)(0, 0), 58.0);
+    EXPECT_DOUBLE_EQ((*c)(0, 1), 64.0);
+    EXPECT_DOUBLE_EQ((*c)(1, 0), 139.0);
+    EXPECT_DOUBLE_EQ((*c)(1, 1), 154.0);
+}
+
+TEST_F(EngineMatmulTest, LargeProductAgainstRowColumnSums)
+{
+    // 150x150 * 150x150 is above the parallel threshold.
+    eval("n = 150; A = ones(n); B = ones(n); C = A * B;");
+    auto *c = getVarPtr("C");
+    ASSERT_EQ(c->numel(), 150u * 150u);
+    EXPECT_DOUBLE_EQ((*c)(0, 0), 150.0);
+    EXPECT_DOUBLE_EQ((*c)(149, 149), 150.0);
+    EXPECT_DOUBLE_EQ((*c)(75, 42), 150.0);
+}
+
+TEST_F(EngineMatmulTest, OddSizesExerciseUnrollTail)
+{
+    // K = 5 exercises the k-unroll remainder.
+    eval("A = [1 2 3 4 5]; B = [1; 2; 3; 4; 5]; s = A * B;");
+    EXPECT_DOUBLE_EQ(getVar("s"), 55.0);
+}
+
+TEST_F(EngineMatmulTest, ComplexProduct)
+{
+    // Matrix literals do not support complex elements; build via promotion.
+    eval("A = [1 3; 0 0] + 1i * [2 0; 0 1]; B = [1 0; 2 1] + 1i * [0 0; 0 -1]; C = A * B;");
+    auto *c = getVarPtr("C");
+    auto c00 = c->complexElem(0, 0);
+    auto c01 = c->complexElem(0, 1);
+    EXPECT_DOUBLE_EQ(c00.real(), 7.0);
+    EXPECT_DOUBLE_EQ(c00.imag(), 2.0);
+    EXPECT_DOUBLE_EQ(c01.real(), 3.0);
+    EXPECT_DOUBLE_EQ(c01.imag(), -3.0);
+}
+
+TEST_F(EngineMatmulTest, InnerDimensionMismatchThrows)
+{
+    EXPECT_THROW(eval("[1 2 3] * [1 2 3];"), std::runtime_error);
+}
+
+// ============================================================
+// Small-value optimization (inline scalar storage)
+// ============================================================
+
+class EngineSmallValueTest : public EngineTest
+{};
+
+TEST_F(EngineSmallValueTest, ScalarFactoriesDoNotAllocate)
+{
+    size_t allocations = 0;
+    Allocator counting{[&allocations](size_t n) -> void * {
+                           ++allocations;
+                           return ::operator new(n);
+                       },
+                       [](void *p, size_t) { ::operator delete(p); }};
+
+    auto d = MValue::scalar(3.5, &counting);
+    auto l = MValue::logicalScalar(true, &counting);
+    auto c = MValue::complexScalar(1.0, -2.0, &counting);
+    EXPECT_EQ(allocations, 0u);
+
+    EXPECT_DOUBLE_EQ(d.toScalar(), 3.5);
+    EXPECT_TRUE(l.toBool());
+    EXPECT_DOUBLE_EQ(c.toComplex().imag(), -2.0);
+}
+
+TEST_F(EngineSmallValueTest, CopiesAreIndependent)
+{
+    auto a = MValue::scalar(1.0);
+    auto b = a;
+    *b.doubleDataMut() = 2.0;
+    EXPECT_DOUBLE_EQ(a.toScalar(), 1.0);
+    EXPECT_DOUBLE_EQ(b.toScalar(), 2.0);
+}
+
+TEST_F(EngineSmallValueTest, ScalarGrowsIntoBufferOnIndexedAssign)
+{
+    eval("A = 5; A(3) = 7;");
+    auto *a = getVarPtr("A");
+    ASSERT_EQ(a->numel(), 3u);
+    EXPECT_DOUBLE_EQ((*a)(0), 5.0);
+    EXPECT_DOUBLE_EQ((*a)(1), 0.0);
+    EXPECT_DOUBLE_EQ((*a)(2), 7.0);
+}
+
+TEST_F(EngineSmallValueTest, InlineDoublePromotesToInlineComplex)
+{
+    eval("z = 2 + 3i;");
+    auto z = getVarPtr("z")->toComplex();
+    EXPECT_DOUBLE_EQ(z.real(), 2.0);
+    EXPECT_DOUBLE_EQ(z.imag(), 3.0);
+}
+
+TEST_F(EngineSmallValueTest, LoopCountersStayCorrect)
+{
+    eval("t = 0; for k = 1:500 t = t + k; end");
+    EXPECT_DOUBLE_EQ(getVar("t"), 125250.0);
+}
+
+// ============================================================
+// Allocator strategies (pool / arena / fast path)
+// ============================================================
+
+class EngineAllocatorTest : public ::testing::Test
+{};
+
+TEST_F(EngineAllocatorTest, PoolReusesFreedChunks)
+{
+    PoolAllocator pool;
+    Allocator alloc = pool.allocator();
+
+    void *p1 = alloc.allocateFast(alloc.ctx, 24);
+    alloc.deallocateFast(alloc.ctx, p1, 24);
+    void *p2 = alloc.allocateFast(alloc.ctx, 24);
+    EXPECT_EQ(p1, p2); // LIFO free list hands the chunk straight back
+    alloc.deallocateFast(alloc.ctx, p2, 24);
+    EXPECT_EQ(pool.slabCount(), 1u);
+}
+
+TEST_F(EngineAllocatorTest, PoolLargeAllocationsFallThrough)
+{
+    PoolAllocator pool;
+    Allocator alloc = pool.allocator();
+    void *p = alloc.allocateFast(alloc.ctx, 10000);
+    ASSERT_NE(p, nullptr);
+    alloc.deallocateFast(alloc.ctx, p, 10000);
+    EXPECT_EQ(pool.slabCount(), 0u);
+}
+
+TEST_F(EngineAllocatorTest, EngineRunsOnPoolAllocator)
+{
+    PoolAllocator pool;
+    Engine engine;
+    engine.setAllocator(pool.allocator());
+    StdLibrary::install(engine);
+    engine.setOutputFunc([](const std::string &) {});
+
+    engine.eval("v = 1:100; s = sum(v .* v);");
+    EXPECT_DOUBLE_EQ(engine.getVariable("s")->toScalar(), 338350.0);
+}
+
+TEST_F(EngineAllocatorTest, ArenaBumpsAndResets)
+{
+    ArenaAllocator arena(1024);
+    Allocator alloc = arena.allocator();
+
+    void *a = alloc.allocateFast(alloc.ctx, 100);
+    void *b = alloc.allocateFast(alloc.ctx, 100);
+    EXPECT_NE(a, b);
+    EXPECT_GE(arena.bytesAllocated(), 200u);
+
+    alloc.deallocateFast(alloc.ctx, a, 100); // no-op
+    arena.reset();
+    EXPECT_EQ(arena.bytesAllocated(), 0u);
+
+    void *c = alloc.allocateFast(alloc.ctx, 100);
+    EXPECT_EQ(c, a); // bump pointer rewound to the first block
+}
+
+TEST_F(EngineAllocatorTest, ArenaScopedEvaluation)
+{
+    ArenaAllocator arena;
+    {
+        Engine engine;
+        engine.setAllocator(arena.allocator());
+        StdLibrary::install(engine);
+        engine.setOutputFunc([](const std::string &) {});
+        engine.eval("t = 0; for k = 1:50 t = t + k; end m = ones(10) * 2;");
+        EXPECT_DOUBLE_EQ(engine.getVariable("t")->toScalar(), 1275.0);
+        EXPECT_DOUBLE_EQ((*engine.getVariable("m"))(5, 5), 2.0);
+    }
+    // Engine (and every value it held) is gone; reclaim wholesale.
+    arena.reset();
+}
+
+// ============================================================
+// Copy-on-write cells & structs
+// ============================================================
+
+class EngineCowContainerTest : public EngineTest
+{};
+
+TEST_F(EngineCowContainerTest, StructCopyIsIndependent)
+{
+    eval("s.a = 1; s.b = 2; t = s; t.a = 99;");
+    EXPECT_DOUBLE_EQ(getVarPtr("s")->field("a").toScalar(), 1.0);
+    EXPECT_DOUBLE_EQ(getVarPtr("t")->field("a").toScalar(), 99.0);
+    EXPECT_DOUBLE_EQ(getVarPtr("t")->field("b").toScalar(), 2.0);
+}
+
+TEST_F(EngineCowContainerTest, CellCopyIsIndependent)
+{
+    eval("c = {1, 'two', 3}; d = c; d{1} = 100;");
+    EXPECT_DOUBLE_EQ(getVarPtr("c")->cellAt(0).toScalar(), 1.0);
+    EXPECT_DOUBLE_EQ(getVarPtr("d")->cellAt(0).toScalar(), 100.0);
+    EXPECT_EQ(getVarPtr("d")->cellAt(1).toString(), "two");
+}
+
+TEST_F(EngineCowContainerTest, CopyingLargeCellIsCheapUntilMutation)
+{
+    auto big = MValue::cell(1, 10000);
+    for (size_t i = 0; i < 10000; ++i)
+        big.cellAt(i) = MValue::scalar(static_cast<double>(i));
+
+    MValue copy = big;            // O(1): shares the container
+    EXPECT_DOUBLE_EQ(copy.cellAt(5000).toScalar(), 5000.0); // detaches here
+    copy.cellAt(0) = MValue::scalar(-1.0);
+    EXPECT_DOUBLE_EQ(big.cellAt(0).toScalar(), 0.0);
+    EXPECT_DOUBLE_EQ(copy.cellAt(0).toScalar(), -1.0);
+}
+
+TEST_F(EngineCowContainerTest, StructPassedToFunctionKeepsCallerCopy)
+{
+    eval(R"(
+        function r = poke(s)
+            s.x = -5;
+            r = s.x;
+        end
+    )");
+    eval("q.x = 7; out = poke(q);");
+    EXPECT_DOUBLE_EQ(getVar("out"), -5.0);
+    EXPECT_DOUBLE_EQ(getVarPtr("q")->field("x").toScalar(), 7.0);
+}
+
+TEST_F(EngineCowContainerTest, RmfieldOperatesOnDetachedCopy)
+{
+    eval("s.a = 1; s.b = 2; u = rmfield(s, 'a');");
+    EXPECT_TRUE(getVarPtr("s")->hasField("a"));
+    EXPECT_FALSE(getVarPtr("u")->hasField("a"));
+    EXPECT_TRUE(getVarPtr("u")->hasField("b"));
+}
+
+// ============================================================
+// Lazy colon ranges
+// ============================================================
+
+class EngineRangeTest : public EngineTest
+{};
+
+TEST_F(EngineRangeTest, ColonProducesLazyRange)
+{
+    auto v = eval("1:1000;");
+    EXPECT_TRUE(v.isRange());
+    EXPECT_EQ(v.numel(), 1000u);
+    EXPECT_DOUBLE_EQ(v(0), 1.0);
+    EXPECT_DOUBLE_EQ(v(999), 1000.0);
+}
+
+TEST_F(EngineRangeTest, HugeLoopRangeDoesNotAllocate)
+{
+    size_t allocations = 0;
+    engine.setAllocator({[&allocations](size_t n) -> void * {
+                             ++allocations;
+                             return ::operator new(n);
+                         },
+                         [](void *p, size_t) { ::operator delete(p); }});
+    eval("cnt = 0;");
+    size_t before = allocations;
+    eval("for i = 1:2000000 cnt = cnt + 1; end");
+    // The loop range itself must not materialize 16 MB of doubles.
+    EXPECT_LT(allocations - before, 10u);
+    EXPECT_DOUBLE_EQ(getVar("cnt"), 2000000.0);
+}
+
+TEST_F(EngineRangeTest, SumAndMeanStayLazy)
+{
+    EXPECT_DOUBLE_EQ(evalScalar("sum(1:100000);"), 5000050000.0);
+    EXPECT_DOUBLE_EQ(evalScalar("mean(1:101);"), 51.0);
+}
+
+TEST_F(EngineRangeTest, IndexingWithRange)
+{
+    eval("A = [10 20 30 40 50]; B = A(2:4);");
+    auto *b = getVarPtr("B");
+    ASSERT_EQ(b->numel(), 3u);
+    EXPECT_DOUBLE_EQ((*b)(0), 20.0);
+    EXPECT_DOUBLE_EQ((*b)(2), 40.0);
+}
+
+TEST_F(EngineRangeTest, MaterializesOnMutation)
+{
+    eval("r = 1:5; r(2) = 99;");
+    auto *r = getVarPtr("r");
+    EXPECT_FALSE(r->isRange());
+    EXPECT_DOUBLE_EQ((*r)(1), 99.0);
+    EXPECT_DOUBLE_EQ((*r)(4), 5.0);
+}
+
+TEST_F(EngineRangeTest, FractionalStepMatchesEagerSemantics)
+{
+    eval("r = 0:0.25:1;");
+    auto *r = getVarPtr("r");
+    ASSERT_EQ(r->numel(), 5u);
+    EXPECT_DOUBLE_EQ((*r)(4), 1.0);
+    eval("d = 10:-3:1;");
+    auto *d = getVarPtr("d");
+    ASSERT_EQ(d->numel(), 4u);
+    EXPECT_DOUBLE_EQ((*d)(3), 1.0);
+}
+
+TEST_F(EngineRangeTest, RangeConcatenationMaterializes)
+{
+    eval("m = [1:3, 7];");
+    auto *m = getVarPtr("m");
+    ASSERT_EQ(m->numel(), 4u);
+    EXPECT_DOUBLE_EQ((*m)(2), 3.0);
+    EXPECT_DOUBLE_EQ((*m)(3), 7.0);
+}
+
+// ============================================================
+// Interned field names / flat struct layout
+// ============================================================
+
+class EngineStructLayoutTest : public EngineTest
+{};
+
+TEST_F(EngineStructLayoutTest, FieldsKeepInsertionOrder)
+{
+    eval("s.zz = 1; s.aa = 2; s.mm = 3;");
+    auto *s = getVarPtr("s");
+    ASSERT_EQ(s->fieldCount(), 3u);
+    EXPECT_EQ(s->fieldNameAt(0), "zz");
+    EXPECT_EQ(s->fieldNameAt(1), "aa");
+    EXPECT_EQ(s->fieldNameAt(2), "mm");
+}
+
+TEST_F(EngineStructLayoutTest, InternedIdsAreStable)
+{
+    uint32_t a1 = internFieldName("alpha");
+    uint32_t a2 = internFieldName("alpha");
+    uint32_t b = internFieldName("beta");
+    EXPECT_EQ(a1, a2);
+    EXPECT_NE(a1, b);
+    EXPECT_EQ(fieldNameById(a1), "alpha");
+}
+
+TEST_F(EngineStructLayoutTest, HotFieldAccessInLoop)
+{
+    eval("rec.x = 0; for i = 1:1000 rec.x = rec.x + i; end");
+    EXPECT_DOUBLE_EQ(getVarPtr("rec")->field("x").toScalar(), 500500.0);
+}
+
+TEST_F(EngineStructLayoutTest, FieldnamesAndRmfieldWork)
+{
+    eval("s.a = 1; s.b = 2; names = fieldnames(s); t = rmfield(s, 'a');");
+    auto *names = getVarPtr("names");
+    ASSERT_EQ(names->numel(), 2u);
+    EXPECT_EQ(names->cellAt(0).toString(), "a");
+    EXPECT_EQ(names->cellAt(1).toString(), "b");
+    EXPECT_FALSE(getVarPtr("t")->hasField("a"));
+    EXPECT_TRUE(getVarPtr("s")->hasField("a"));
+}
+
+TEST_F(EngineStructLayoutTest, NestedFieldAssignment)
+{
+    eval("cfg.net.port = 8080; cfg.net.host = 'x'; p = cfg.net.port;");
+    EXPECT_DOUBLE_EQ(getVar("p"), 8080.0);
+}
+
+TEST_F(EngineStructLayoutTest, MissingFieldStillThrows)
+{
+    eval("s.a = 1;");
+    EXPECT_THROW(eval("y = s.nope;"), std::runtime_error);
+}
+
+// ============================================================
+// In-place arithmetic on uniquely-owned buffers
+// ============================================================
+
+class EngineInPlaceTest : public EngineTest
+{};
+
+TEST_F(EngineInPlaceTest, SelfUpdateKeepsBuffer)
+{
+    eval("a = zeros(1, 1000);");
+    const void *before = getVarPtr("a")->rawData();
+    eval("a = a + 1;");
+    EXPECT_EQ(getVarPtr("a")->rawData(), before);
+    EXPECT_DOUBLE_EQ((*getVarPtr("a"))(999), 1.0);
+}
+
+TEST_F(EngineInPlaceTest, SharedBufferIsNotTouched)
+{
+    eval("a = ones(1, 100); b = a; a = a + 1;");
+    EXPECT_DOUBLE_EQ((*getVarPtr("a"))(0), 2.0);
+    EXPECT_DOUBLE_EQ((*getVarPtr("b"))(0), 1.0); // copy must keep old values
+}
+
+TEST_F(EngineInPlaceTest, SelfReferenceOnBothSides)
+{
+    eval("a = [1 2 3]; a = a + a;");
+    auto *a = getVarPtr("a");
+    EXPECT_DOUBLE_EQ((*a)(0), 2.0);
+    EXPECT_DOUBLE_EQ((*a)(2), 6.0);
+}
+
+TEST_F(EngineInPlaceTest, MatrixRhsAndScalarRhs)
+{
+    eval("a = [1 2; 3 4]; a = a .* 2; a = a - [1 1; 1 1];");
+    auto *a = getVarPtr("a");
+    EXPECT_DOUBLE_EQ((*a)(0, 0), 1.0);
+    EXPECT_DOUBLE_EQ((*a)(1, 1), 7.0);
+}
+
+TEST_F(EngineInPlaceTest, ShapeChangeFallsBack)
+{
+    // rhs is a matrix while '*' in-place only covers scalar rhs.
+    eval("a = [1 2; 3 4]; a = a * [1 0; 0 1];");
+    auto *a = getVarPtr("a");
+    EXPECT_DOUBLE_EQ((*a)(1, 0), 3.0);
+}
+
+TEST_F(EngineInPlaceTest, SideEffectsInRhsRunOnce)
+{
+    eval(R"(
+        function r = bump()
+            global n;
+            n = n + 1;
+            r = 1;
+        end
+    )");
+    eval("global n; n = 0; a = [1 2 3]; a = a + bump();");
+    EXPECT_DOUBLE_EQ(getVar("n"), 1.0);
+    EXPECT_DOUBLE_EQ((*getVarPtr("a"))(0), 2.0);
+}
+
+TEST_F(EngineInPlaceTest, DisabledFlagStillCorrect)
+{
+    engine.setInPlaceArithmetic(false);
+    eval("a = [1 2 3]; a = a + 10;");
+    EXPECT_DOUBLE_EQ((*getVarPtr("a"))(2), 13.0);
+}
+
+// ============================================================
+// Geometric growth for incremental append
+// ============================================================
+
+class EngineAppendTest : public EngineTest
+{};
+
+TEST_F(EngineAppendTest, AppendLoopIsAmortized)
+{
+    size_t allocations = 0;
+    engine.setAllocator({[&allocations](size_t n) -> void * {
+                             ++allocations;
+                             return ::operator new(n);
+                         },
+                         [](void *p, size_t) { ::operator delete(p); }});
+    eval("A = 0;");
+    size_t before = allocations;
+    eval("for k = 1:10000 A(end+1) = k; end");
+    // Geometric growth: ~log2(10000) reallocations, not ~10000.
+    EXPECT_LT(allocations - before, 40u);
+
+    auto *a = getVarPtr("A");
+    ASSERT_EQ(a->numel(), 10001u);
+    EXPECT_DOUBLE_EQ((*a)(0), 0.0);
+    EXPECT_DOUBLE_EQ((*a)(10000), 10000.0);
+}
+
+TEST_F(EngineAppendTest, NumelReportsLogicalSize)
+{
+    eval("A = [1 2 3]; A(end+1) = 4;");
+    auto *a = getVarPtr("A");
+    EXPECT_EQ(a->numel(), 4u);
+    EXPECT_EQ(a->rawBytes(), 4u * sizeof(double));
+}
+
+TEST_F(EngineAppendTest, SharedBufferAppendCopies)
+{
+    eval("A = [1 2 3]; B = A; A(end+1) = 4;");
+    EXPECT_EQ(getVarPtr("A")->numel(), 4u);
+    EXPECT_EQ(getVarPtr("B")->numel(), 3u);
+    EXPECT_DOUBLE_EQ((*getVarPtr("B"))(2), 3.0);
+}
+
+TEST_F(EngineAppendTest, ColumnVectorAppend)
+{
+    // ensureSize has always flattened vectors to a row on linear growth.
+    eval("v = [1; 2; 3]; v(end+1) = 4;");
+    auto *v = getVarPtr("v");
+    ASSERT_EQ(v->numel(), 4u);
+    EXPECT_EQ(v->dims().cols(), 4u);
+    EXPECT_DOUBLE_EQ((*v)(3), 4.0);
+}
+
+TEST_F(EngineAppendTest, MatrixResizeStillRelayouts)
+{
+    eval("M = [1 2; 3 4]; M(3, 3) = 9;");
+    auto *m = getVarPtr("M");
+    EXPECT_EQ(m->dims().rows(), 3u);
+    EXPECT_EQ(m->dims().cols(), 3u);
+    EXPECT_DOUBLE_EQ((*m)(0, 0), 1.0);
+    EXPECT_DOUBLE_EQ((*m)(1, 1), 4.0);
+    EXPECT_DOUBLE_EQ((*m)(2, 2), 9.0);
+    EXPECT_DOUBLE_EQ((*m)(0, 2), 0.0);
+}
+
+// ============================================================
+// Direct-dispatch builtins (FastFunc)
+// ============================================================
+
+class EngineFastCallTest : public EngineTest
+{};
+
+TEST_F(EngineFastCallTest, ScalarMathInLoop)
+{
+    eval("s = 0; for i = 1:100 s = s + sin(0) + abs(-i); end");
+    EXPECT_DOUBLE_EQ(getVar("s"), 5050.0);
+}
+
+TEST_F(EngineFastCallTest, VariableShadowsBuiltin)
+{
+    eval("sin = [10 20 30]; v = sin(2);");
+    EXPECT_DOUBLE_EQ(getVar("v"), 20.0);
+    eval("clear('sin'); w = sin(0);");
+    EXPECT_DOUBLE_EQ(getVar("w"), 0.0);
+}
+
+TEST_F(EngineFastCallTest, HostRegisteredFastFunction)
+{
+    engine.registerFastFunction("triple", [](const MValue *args, size_t n) -> MValue {
+        return MValue::scalar(n >= 1 ? args[0].toScalar() * 3 : 0.0);
+    });
+    // Registered after nothing was compiled with the name: the runtime
+    // name fallback must still find it.
+    eval("t = triple(14);");
+    EXPECT_DOUBLE_EQ(getVar("t"), 42.0);
+}
+
+TEST_F(EngineFastCallTest, FastFunctionThroughHandle)
+{
+    eval("f = @sin; y = f(0);");
+    EXPECT_DOUBLE_EQ(getVar("y"), 0.0);
+}
+
+TEST_F(EngineFastCallTest, ModAndRemStillBinary)
+{
+    EXPECT_DOUBLE_EQ(evalScalar("mod(10, 3);"), 1.0);
+    EXPECT_DOUBLE_EQ(evalScalar("rem(-10, 3);"), -1.0);
+    EXPECT_DOUBLE_EQ(evalScalar("mod(-10, 3);"), 2.0);
+}
+
+// ============================================================
+// Free-variable closure capture
+// ============================================================
+
+class EngineClosureTest : public EngineTest
+{};
+
+TEST_F(EngineClosureTest, CapturesReferencedValueAtCreation)
+{
+    eval("k = 10; f = @(x) x + k; k = 99; y = f(1);");
+    EXPECT_DOUBLE_EQ(getVar("y"), 11.0); // value frozen at creation
+}
+
+TEST_F(EngineClosureTest, UnreferencedLargeDataIsNotCopied)
+{
+    size_t allocations = 0;
+    engine.setAllocator({[&allocations](size_t n) -> void * {
+                             ++allocations;
+                             return ::operator new(n);
+                         },
+                         [](void *p, size_t) { ::operator delete(p); }});
+    eval("big = zeros(1, 100000); k = 2;");
+    size_t before = allocations;
+    eval("for i = 1:100 h = @(x) x * k; end");
+    // CoW capture of k only: no 800 KB copies of `big` per handle.
+    EXPECT_LT(allocations - before, 20u);
+    EXPECT_DOUBLE_EQ(evalScalar("h(21);"), 42.0);
+}
+
+TEST_F(EngineClosureTest, HandleSurvivesClearOfCaptured)
+{
+    eval("a = 5; f = @() a * 2; clear('a'); r = f();");
+    EXPECT_DOUBLE_EQ(getVar("r"), 10.0);
+}
+
+TEST_F(EngineClosureTest, NestedAnonymousFunctions)
+{
+    eval("c = 3; outer = @(x) x + c; comp = @(x) outer(x) * 2; v = comp(4);");
+    EXPECT_DOUBLE_EQ(getVar("v"), 14.0);
+}
+
+TEST_F(EngineClosureTest, GlobalStaysLiveInsideHandle)
+{
+    eval("global g; g = 1; f = @() g; g = 7;");
+    EXPECT_DOUBLE_EQ(evalScalar("f();"), 7.0);
+}
+
+TEST_F(EngineClosureTest, HandleCallsNamedFunction)
+{
+    eval(R"(
+        function r = dbl(x)
+            r = 2 * x;
+        end
+    )");
+    eval("f = @(x) dbl(x) + 1; y = f(5);");
+    EXPECT_DOUBLE_EQ(getVar("y"), 11.0);
+}
+
+// ============================================================
+// arrayfun / cellfun
+// ============================================================
+
+class EngineMapFunTest : public EngineTest
+{};
+
+TEST_F(EngineMapFunTest, ArrayfunBasic)
+{
+    eval("r = arrayfun(@(x) x * 2, [1 2 3 4]);");
+    auto *r = getVarPtr("r");
+    ASSERT_EQ(r->numel(), 4u);
+    EXPECT_DOUBLE_EQ((*r)(3), 8.0);
+}
+
+TEST_F(EngineMapFunTest, ArrayfunMultipleInputs)
+{
+    eval("r = arrayfun(@(a, b) a + b, [1 2 3], [10 20 30]);");
+    EXPECT_DOUBLE_EQ((*getVarPtr("r"))(2), 33.0);
+}
+
+TEST_F(EngineMapFunTest, ArrayfunNonUniform)
+{
+    eval("c = arrayfun(@(x) x, [1 2], 'UniformOutput', false);");
+    auto *c = getVarPtr("c");
+    ASSERT_TRUE(c->isCell());
+    EXPECT_DOUBLE_EQ(c->cellAt(1).toScalar(), 2.0);
+}
+
+TEST_F(EngineMapFunTest, ArrayfunNonScalarResultThrows)
+{
+    EXPECT_THROW(eval("arrayfun(@(x) [x x], [1 2]);"), std::runtime_error);
+}
+
+TEST_F(EngineMapFunTest, ArrayfunParallelMatchesSerial)
+{
+    eval(R"(
+        function r = work(x)
+            r = 0;
+            for k = 1:50
+                r = r + mod(x * k, 7);
+            end
+        end
+    )");
+    eval("v = 1:200;");
+    eval("serial = arrayfun(@work, v);");
+    eval("par = arrayfun(@work, v, 'UseParallel', true);");
+    eval("same = sum(abs(serial - par)) == 0;");
+    EXPECT_TRUE(engine.getVariable("same")->toBool());
+}
+
+TEST_F(EngineMapFunTest, CellfunBasic)
+{
+    eval("c = {1, 2, 3}; r = cellfun(@(x) x + 1, c);");
+    EXPECT_DOUBLE_EQ((*getVarPtr("r"))(2), 4.0);
+}
+
+TEST_F(EngineMapFunTest, CellfunNonUniformStrings)
+{
+    eval("c = {'ab', 'cde'}; r = cellfun(@(s) upper(s), c, 'UniformOutput', false);");
+    EXPECT_EQ(getVarPtr("r")->cellAt(1).toString(), "CDE");
+}
+
+TEST_F(EngineMapFunTest, UnknownOptionThrows)
+{
+    EXPECT_THROW(eval("arrayfun(@(x) x, [1], 'Bogus', true);"), std::runtime_error);
+}
+
+// ============================================================
+// Vectorized logical mask operations
+// ============================================================
+
+class EngineMaskTest : public EngineTest
+{};
+
+TEST_F(EngineMaskTest, WordWideAndOrNot)
+{
+    // 1000 elements exercises the word loop plus the byte tail.
+    eval("v = 1:1000; a = mod(v, 2) == 0; b = v > 500;");
+    eval("both = a & b; either = a | b; neither = ~either;");
+    // evens above 500: 250; evens or >500: 500 evens + 250 odds above 500
+    eval("cb = 0; for i = 1:1000 if both(i) cb = cb + 1; end end");
+    eval("ce = 0; for i = 1:1000 if either(i) ce = ce + 1; end end");
+    EXPECT_DOUBLE_EQ(getVar("cb"), 250.0);
+    EXPECT_DOUBLE_EQ(getVar("ce"), 750.0);
+}
+
+TEST_F(EngineMaskTest, LogicalIndexingLargeMask)
+{
+    eval("v = 1:1000; picked = v(v > 990);");
+    auto *p = getVarPtr("picked");
+    ASSERT_EQ(p->numel(), 10u);
+    EXPECT_DOUBLE_EQ((*p)(0), 991.0);
+    EXPECT_DOUBLE_EQ((*p)(9), 1000.0);
+}
+
+TEST_F(EngineMaskTest, FindOnSparseMask)
+{
+    eval("v = zeros(1, 1000); v(17) = 1; v(999) = 1; idx = find(v > 0);");
+    auto *idx = getVarPtr("idx");
+    ASSERT_EQ(idx->numel(), 2u);
+    EXPECT_DOUBLE_EQ((*idx)(0), 17.0);
+    EXPECT_DOUBLE_EQ((*idx)(1), 999.0);
+}
+
+TEST_F(EngineMaskTest, ComparisonChainsStayCorrect)
+{
+    eval("v = [3 1 4 1 5]; m = (v >= 3) & (v ~= 4);");
+    auto *m = getVarPtr("m");
+    const uint8_t *d = m->logicalData();
+    EXPECT_EQ(d[0], 1);
+    EXPECT_EQ(d[1], 0);
+    EXPECT_EQ(d[2], 0);
+    EXPECT_EQ(d[4], 1);
+}
+
+// ============================================================
+// Native integer types
+// ============================================================
+
+class EngineIntegerTest : public EngineTest
+{};
+
+TEST_F(EngineIntegerTest, ConversionAndClass)
+{
+    eval("a = uint16([1 2 70000]);");
+    auto *a = getVarPtr("a");
+    EXPECT_EQ(a->type(), MType::UINT16);
+    const uint16_t *p = static_cast<const uint16_t *>(a->rawData());
+    EXPECT_EQ(p[0], 1);
+    EXPECT_EQ(p[2], 65535); // saturated
+    EXPECT_EQ(evalString("class(a);"), "uint16");
+}
+
+TEST_F(EngineIntegerTest, TypePreservingArithmetic)
+{
+    eval("x = int32([100 200]); y = int32([1 2]); z = x + y;");
+    auto *z = getVarPtr("z");
+    EXPECT_EQ(z->type(), MType::INT32);
+    const int32_t *p = static_cast<const int32_t *>(z->rawData());
+    EXPECT_EQ(p[1], 202);
+}
+
+TEST_F(EngineIntegerTest, SaturationOnOverflow)
+{
+    eval("a = int8(120) + int8(100);");
+    EXPECT_DOUBLE_EQ(getVarPtr("a")->toScalar(), 127.0);
+    eval("b = uint8(5) - uint8(9);");
+    EXPECT_DOUBLE_EQ(getVarPtr("b")->toScalar(), 0.0);
+    eval("c = int16(-30000) - int16(10000);");
+    EXPECT_DOUBLE_EQ(getVarPtr("c")->toScalar(), -32768.0);
+}
+
+TEST_F(EngineIntegerTest, MixedWithDoubleScalar)
+{
+    eval("v = int32([3 4]) + 0.6;");
+    auto *v = getVarPtr("v");
+    EXPECT_EQ(v->type(), MType::INT32);
+    const int32_t *p = static_cast<const int32_t *>(v->rawData());
+    EXPECT_EQ(p[0], 4); // 3.6 rounds
+    EXPECT_EQ(p[1], 5);
+}
+
+TEST_F(EngineIntegerTest, Int64KeepsPrecision)
+{
+    // Literals parse as doubles, so build 2^53 + 1 with int64 arithmetic.
+    eval("big = int64(4503599627370496) * int64(2) + int64(1);");
+    eval("bigger = big + int64(1);");
+    const int64_t *p = static_cast<const int64_t *>(getVarPtr("bigger")->rawData());
+    EXPECT_EQ(*p, 9007199254740994ll);
+}
+
+TEST_F(EngineIntegerTest, ComparisonsAndReductions)
+{
+    eval("v = uint8([3 200 7]); m = v > 100;");
+    EXPECT_EQ(getVarPtr("m")->logicalData()[1], 1);
+    eval("s = sum(v); mx = max(v); mn = min(v);");
+    EXPECT_EQ(getVarPtr("s")->type(), MType::UINT8);
+    EXPECT_DOUBLE_EQ(getVarPtr("s")->toScalar(), 210.0);
+    EXPECT_DOUBLE_EQ(getVarPtr("mx")->toScalar(), 200.0);
+    EXPECT_DOUBLE_EQ(getVarPtr("mn")->toScalar(), 3.0);
+}
+
+TEST_F(EngineIntegerTest, SaturatingSum)
+{
+    eval("s = sum(uint8([200 200 200]));");
+    EXPECT_DOUBLE_EQ(getVarPtr("s")->toScalar(), 255.0);
+}
+
+TEST_F(EngineIntegerTest, RoundTripToDouble)
+{
+    eval("d = double(int16([-5 7]));");
+    auto *d = getVarPtr("d");
+    EXPECT_EQ(d->type(), MType::DOUBLE);
+    EXPECT_DOUBLE_EQ((*d)(1), 7.0);
+    EXPECT_TRUE(engine.eval("isinteger(int8(1));").toBool());
+    EXPECT_FALSE(engine.eval("isinteger(1);").toBool());
+}
+
+TEST_F(EngineIntegerTest, MismatchedIntClassesThrow)
+{
+    EXPECT_THROW(eval("int8(1) + int16(1);"), std::runtime_error);
+}
+
+// ============================================================
+// Workspace serialization (save/load)
+// ============================================================
+
+#include <cstdio>
+#include <fstream>
+
+class EngineWorkspaceTest : public EngineTest
+{
+public:
+    std::string path = "test_workspace.mlabws";
+
+    void TearDown() override { std::remove(path.c_str()); }
+};
+
+TEST_F(EngineWorkspaceTest, RoundTripAllTypes)
+{
+    eval("a = 42; v = [1 2; 3 4]; s = 'hello'; L = [1 0 1] > 0;");
+    eval("z = 1 + 2i; c = {1, 'two'}; st.x = 7; st.y = [8 9]; f = @sin;");
+    eval("u = uint16([5 70000]);");
+    engine.saveWorkspace(path);
+
+    Engine fresh;
+    StdLibrary::install(fresh);
+    fresh.setOutputFunc([](const std::string &) {});
+    fresh.loadWorkspace(path);
+
+    EXPECT_DOUBLE_EQ(fresh.getVariable("a")->toScalar(), 42.0);
+    EXPECT_DOUBLE_EQ((*fresh.getVariable("v"))(1, 0), 3.0);
+    EXPECT_EQ(fresh.getVariable("s")->toString(), "hello");
+    EXPECT_EQ(fresh.getVariable("L")->logicalData()[1], 0);
+    EXPECT_DOUBLE_EQ(fresh.getVariable("z")->toComplex().imag(), 2.0);
+    EXPECT_EQ(fresh.getVariable("c")->cellAt(1).toString(), "two");
+    EXPECT_DOUBLE_EQ(fresh.getVariable("st")->field("x").toScalar(), 7.0);
+    EXPECT_EQ(fresh.getVariable("f")->funcHandleName(), "sin");
+    EXPECT_EQ(fresh.getVariable("u")->type(), MType::UINT16);
+    const uint16_t *up = static_cast<const uint16_t *>(fresh.getVariable("u")->rawData());
+    EXPECT_EQ(up[1], 65535);
+
+    fresh.eval("r = sum(v(1, :)) + st.y(2);");
+    EXPECT_DOUBLE_EQ(fresh.getVariable("r")->toScalar(), 12.0);
+}
+
+TEST_F(EngineWorkspaceTest, SaveLoadBuiltins)
+{
+    eval("x = 3.5; save('" + path + "'); clear('x');");
+    EXPECT_EQ(engine.getVariable("x"), nullptr);
+    eval("load('" + path + "');");
+    EXPECT_DOUBLE_EQ(getVar("x"), 3.5);
+}
+
+TEST_F(EngineWorkspaceTest, LazyRangeSavesMaterialized)
+{
+    eval("r = 1:100;");
+    engine.saveWorkspace(path);
+    Engine fresh;
+    fresh.loadWorkspace(path);
+    EXPECT_EQ(fresh.getVariable("r")->numel(), 100u);
+    EXPECT_DOUBLE_EQ((*fresh.getVariable("r"))(99), 100.0);
+}
+
+TEST_F(EngineWorkspaceTest, BadFileThrows)
+{
+    EXPECT_THROW(engine.loadWorkspace("no_such_file.mlabws"), std::runtime_error);
+    std::ofstream bad(path, std::ios::binary);
+    bad << "garbage data here";
+    bad.close();
+    EXPECT_THROW(engine.loadWorkspace(path), std::runtime_error);
+}
+
+// ============================================================
+// Profiler counters
+// ============================================================
+
+class EngineProfileTest : public EngineTest
+{};
+
+TEST_F(EngineProfileTest, CountsNodesAndBuiltins)
+{
+    eval("profile('on');");
+    eval("s = 0; for i = 1:50 s = s + sin(i); end");
+    eval("profile('off');");
+    auto report = engine.profileReport();
+    ASSERT_TRUE(report.isStruct());
+
+    const auto &nodes = report.field("nodes");
+    ASSERT_TRUE(nodes.hasField("binary_op"));
+    EXPECT_GE(nodes.field("binary_op")(0), 50.0); // count
+
+    const auto &builtins = report.field("builtins");
+    ASSERT_TRUE(builtins.hasField("sin"));
+    EXPECT_DOUBLE_EQ(builtins.field("sin")(0), 50.0);
+}
+
+TEST_F(EngineProfileTest, AllocatorTrafficIsRecorded)
+{
+    eval("profile('on');");
+    eval("m = zeros(100);");
+    eval("profile('off');");
+    auto report = engine.profileReport();
+    EXPECT_GE(report.field("allocBytes").toScalar(), 80000.0);
+}
+
+TEST_F(EngineProfileTest, ResetClearsCounters)
+{
+    eval("profile('on'); x = 1 + 1; profile('off'); profile('reset');");
+    auto report = engine.profileReport();
+    EXPECT_DOUBLE_EQ(report.field("allocCount").toScalar(), 0.0);
+    EXPECT_EQ(report.field("builtins").fieldCount(), 0u);
+}
+
+TEST_F(EngineProfileTest, DisabledProfilingStaysEmpty)
+{
+    eval("y = 2 * 3;");
+    auto report = engine.profileReport();
+    EXPECT_EQ(report.field("nodes").fieldCount(), 0u);
+}
+
+TEST_F(EngineProfileTest, ScriptAccessToReport)
+{
+    eval("profile('on'); q = sqrt(16); profile('off'); p = profile(); n = p.builtins.sqrt(1);");
+    EXPECT_DOUBLE_EQ(getVar("n"), 1.0);
+}
+
+// ============================================================
+// Cooperative execution: interrupt / budget / stepping
+// ============================================================
+
+#include <thread>
+
+class EngineInterruptTest : public EngineTest
+{};
+
+TEST_F(EngineInterruptTest, BudgetStopsRunawayLoop)
+{
+    engine.setExecBudget(10000);
+    EXPECT_THROW(eval("while true x = 1; end"), BudgetExceededError);
+    engine.setExecBudget(0);
+    eval("y = 2;"); // unlimited again
+    EXPECT_DOUBLE_EQ(getVar("y"), 2.0);
+}
+
+TEST_F(EngineInterruptTest, BudgetIsPerEvaluation)
+{
+    engine.setExecBudget(5000);
+    for (int i = 0; i < 5; ++i)
+        eval("s = 0; for k = 1:1000 s = s + 1; end");
+    EXPECT_DOUBLE_EQ(getVar("s"), 1000.0);
+}
+
+TEST_F(EngineInterruptTest, BudgetCoversBytecodeLoops)
+{
+    engine.setExecutionMode(ExecutionMode::BYTECODE);
+    engine.setExecBudget(10000);
+    EXPECT_THROW(eval("while true x = 1; end"), BudgetExceededError);
+}
+
+TEST_F(EngineInterruptTest, InterruptFromAnotherThread)
+{
+    std::thread stopper([this] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        engine.requestInterrupt();
+    });
+    EXPECT_THROW(eval("while true x = 1; end"), InterruptError);
+    stopper.join();
+}
+
+TEST_F(EngineInterruptTest, InterruptPassesThroughTryCatch)
+{
+    std::thread stopper([this] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        engine.requestInterrupt();
+    });
+    EXPECT_THROW(eval("try\n while true x = 1; end\ncatch e\n y = 1;\nend"), InterruptError);
+    stopper.join();
+}
+
+TEST_F(EngineInterruptTest, EvalStepRunsOneStatementAtATime)
+{
+    auto script = engine.compile("a = 1; b = a + 1; c = b * 2;");
+    size_t cursor = 0;
+    EXPECT_TRUE(engine.evalStep(script, cursor));
+    EXPECT_DOUBLE_EQ(getVar("a"), 1.0);
+    EXPECT_EQ(engine.getVariable("b"), nullptr);
+    EXPECT_TRUE(engine.evalStep(script, cursor));
+    EXPECT_FALSE(engine.evalStep(script, cursor));
+    EXPECT_DOUBLE_EQ(getVar("c"), 4.0);
+    EXPECT_FALSE(engine.evalStep(script, cursor)); // past the end
+}
+
+// ============================================================
+// Slice views for contiguous indexing
+// ============================================================
+
+class EngineViewTest : public EngineTest
+{};
+
+TEST_F(EngineViewTest, ColumnSelectionIsZeroCopy)
+{
+    eval("M = rand(200); col = M(:, 7);");
+    auto *m = getVarPtr("M");
+    auto *col = getVarPtr("col");
+    ASSERT_TRUE(col->isView());
+    EXPECT_EQ(col->dims().rows(), 200u);
+    EXPECT_EQ(col->dims().cols(), 1u);
+    // The view aliases M's buffer: same data address, offset applied.
+    EXPECT_EQ(col->rawData(),
+              static_cast<const double *>(m->rawData()) + 6 * 200);
+    EXPECT_DOUBLE_EQ((*col)(5), (*m)(5, 6));
+}
+
+TEST_F(EngineViewTest, FlattenViewSharesBuffer)
+{
+    eval("M = [1 2; 3 4]; f = M(:);");
+    auto *f = getVarPtr("f");
+    // Offset-0 whole-buffer view: indistinguishable from a CoW copy,
+    // which is exactly the zero-copy property we want.
+    EXPECT_EQ(f->numel(), 4u);
+    EXPECT_DOUBLE_EQ((*f)(1), 3.0); // column-major order
+    EXPECT_EQ(f->rawData(), getVarPtr("M")->rawData());
+}
+
+TEST_F(EngineViewTest, WriteToViewMaterializes)
+{
+    eval("M = [1 2; 3 4]; c = M(:, 1); c(1) = 99;");
+    EXPECT_DOUBLE_EQ((*getVarPtr("M"))(0, 0), 1.0); // original untouched
+    EXPECT_DOUBLE_EQ((*getVarPtr("c"))(0), 99.0);
+    EXPECT_FALSE(getVarPtr("c")->isView());
+}
+
+TEST_F(EngineViewTest, ViewSurvivesOriginalReassignment)
+{
+    eval("M = [5 6; 7 8]; c = M(:, 2); M = 0;");
+    auto *c = getVarPtr("c");
+    EXPECT_DOUBLE_EQ((*c)(0), 6.0);
+    EXPECT_DOUBLE_EQ((*c)(1), 8.0);
+}
+
+TEST_F(EngineViewTest, ViewsWorkInExpressions)
+{
+    eval("M = [1 2; 3 4]; s = sum(M(:, 2)); t = M(:, 1)' * M(:, 2);");
+    EXPECT_DOUBLE_EQ(getVar("s"), 6.0);
+    EXPECT_DOUBLE_EQ(getVar("t"), 14.0); // 1*2 + 3*4
+}
+
+TEST_F(EngineViewTest, MultiColumnSelectionStillCopies)
+{
+    eval("M = [1 2 3; 4 5 6]; P = M(:, [1 3]);");
+    auto *p = getVarPtr("P");
+    EXPECT_EQ(p->dims().cols(), 2u);
+    EXPECT_DOUBLE_EQ((*p)(1, 1), 6.0);
+}
+
+TEST_F(EngineViewTest, OutOfRangeColumnThrows)
+{
+    eval("M = [1 2; 3 4];");
+    EXPECT_THROW(eval("M(:, 5);"), std::runtime_error);
+}
+
+// ============================================================
+// Dim-aware reductions
+// ============================================================
+
+class EngineReduceTest : public EngineTest
+{};
+
+TEST_F(EngineReduceTest, SumAlongDims)
+{
+    eval("A = [1 2 3; 4 5 6];");
+    eval("s1 = sum(A, 1); s2 = sum(A, 2);");
+    auto *s1 = getVarPtr("s1");
+    ASSERT_EQ(s1->dims().rows(), 1u);
+    ASSERT_EQ(s1->dims().cols(), 3u);
+    EXPECT_DOUBLE_EQ((*s1)(0), 5.0);
+    EXPECT_DOUBLE_EQ((*s1)(2), 9.0);
+    auto *s2 = getVarPtr("s2");
+    ASSERT_EQ(s2->dims().rows(), 2u);
+    EXPECT_DOUBLE_EQ((*s2)(0), 6.0);
+    EXPECT_DOUBLE_EQ((*s2)(1), 15.0);
+}
+
+TEST_F(EngineReduceTest, MeanAndProdWithDim)
+{
+    eval("A = [2 4; 6 8];");
+    EXPECT_DOUBLE_EQ((*getVarPtr("A"))(0, 0), 2.0);
+    eval("m = mean(A, 2); p = prod(A, 1);");
+    EXPECT_DOUBLE_EQ((*getVarPtr("m"))(0), 3.0);
+    EXPECT_DOUBLE_EQ((*getVarPtr("p"))(1), 32.0);
+}
+
+TEST_F(EngineReduceTest, MinMaxWithDim)
+{
+    eval("A = [3 1; 2 9]; mx = max(A, [], 2); mn = min(A, [], 1);");
+    EXPECT_DOUBLE_EQ((*getVarPtr("mx"))(0), 3.0);
+    EXPECT_DOUBLE_EQ((*getVarPtr("mx"))(1), 9.0);
+    EXPECT_DOUBLE_EQ((*getVarPtr("mn"))(0), 2.0);
+    EXPECT_DOUBLE_EQ((*getVarPtr("mn"))(1), 1.0);
+}
+
+TEST_F(EngineReduceTest, PairwiseSumIsAccurate)
+{
+    // 1e6 values of 0.1: naive accumulation drifts, pairwise stays tight.
+    eval("s = sum(ones(1, 1000000) * 0.1);");
+    EXPECT_NEAR(getVar("s"), 100000.0, 1e-6);
+}
+
+TEST_F(EngineReduceTest, VectorMinMaxStillReturnIndices)
+{
+    eval("[m, i] = max([3 9 1]);");
+    EXPECT_DOUBLE_EQ(getVar("m"), 9.0);
+    EXPECT_DOUBLE_EQ(getVar("i"), 2.0);
+}
+
+TEST_F(EngineReduceTest, PageReduction3D)
+{
+    // 3-D arrays are built host-side (scripts have no 3-D constructors).
+    auto c3 = MValue::matrix3d(2, 2, 3, MType::DOUBLE);
+    c3.elem(0, 0, 0) = 5.0;
+    c3.elem(0, 0, 2) = 7.0;
+    engine.setVariable("C", c3);
+    eval("sp = sum(C, 3);");
+    auto *sp = getVarPtr("sp");
+    ASSERT_EQ(sp->dims().rows(), 2u);
+    EXPECT_DOUBLE_EQ((*sp)(0, 0), 12.0);
+}
+
+// ============================================================
+// EngineContext / EnginePool
+// ============================================================
+
+#include "MLabEnginePool.hpp"
+
+class EnginePoolTest : public ::testing::Test
+{};
+
+TEST_F(EnginePoolTest, ContextEnginesShareLibraryFunctions)
+{
+    auto ctx = std::make_shared<EngineContext>([](Engine &proto) {
+        StdLibrary::install(proto);
+        proto.setOutputFunc([](const std::string &) {});
+        proto.eval(R"(
+            function r = libScale(x)
+                r = x * 10;
+            end
+        )");
+    });
+
+    Engine worker(ctx);
+    worker.setOutputFunc([](const std::string &) {});
+    worker.eval("y = libScale(4) + sin(0);");
+    EXPECT_DOUBLE_EQ(worker.getVariable("y")->toScalar(), 40.0);
+}
+
+TEST_F(EnginePoolTest, WorkersHaveIndependentWorkspaces)
+{
+    auto ctx = std::make_shared<EngineContext>([](Engine &proto) {
+        StdLibrary::install(proto);
+    });
+    Engine a(ctx), b(ctx);
+    a.setOutputFunc([](const std::string &) {});
+    b.setOutputFunc([](const std::string &) {});
+    a.eval("x = 1;");
+    b.eval("x = 2;");
+    EXPECT_DOUBLE_EQ(a.getVariable("x")->toScalar(), 1.0);
+    EXPECT_DOUBLE_EQ(b.getVariable("x")->toScalar(), 2.0);
+}
+
+TEST_F(EnginePoolTest, PoolRecyclesWithCleanWorkspace)
+{
+    auto ctx = std::make_shared<EngineContext>([](Engine &proto) {
+        StdLibrary::install(proto);
+    });
+    EnginePool pool(ctx, 2);
+    EXPECT_EQ(pool.idleCount(), 2u);
+
+    auto e1 = pool.acquire();
+    e1->setOutputFunc([](const std::string &) {});
+    e1->eval("secret = 99;");
+    Engine *raw = e1.get();
+    pool.release(std::move(e1));
+    EXPECT_EQ(pool.idleCount(), 2u);
+
+    auto e2 = pool.acquire();
+    EXPECT_EQ(e2.get(), raw); // O(1) reuse of the same engine
+    EXPECT_EQ(e2->getVariable("secret"), nullptr);
+    e2->setOutputFunc([](const std::string &) {});
+    e2->eval("p = pi;"); // constants re-seeded after the clear
+    EXPECT_NEAR(e2->getVariable("p")->toScalar(), 3.14159, 1e-4);
+}
+
+TEST_F(EnginePoolTest, AcquireBeyondPreallocationCreates)
+{
+    auto ctx = std::make_shared<EngineContext>([](Engine &proto) {
+        StdLibrary::install(proto);
+    });
+    EnginePool pool(ctx, 1);
+    auto e1 = pool.acquire();
+    auto e2 = pool.acquire(); // pool empty → fresh context engine
+    e2->setOutputFunc([](const std::string &) {});
+    e2->eval("v = sqrt(25);");
+    EXPECT_DOUBLE_EQ(e2->getVariable("v")->toScalar(), 5.0);
+}
+
+// ============================================================
+// Batched display with truncation
+// ============================================================
+
+class EngineDisplayBatchTest : public EngineTest
+{};
+
+TEST_F(EngineDisplayBatchTest, SingleOutputCallPerStatement)
+{
+    int calls = 0;
+    engine.setOutputFunc([&calls](const std::string &) { ++calls; });
+    eval("A = [1 2; 3 4]");
+    EXPECT_EQ(calls, 1);
+}
+
+TEST_F(EngineDisplayBatchTest, LargeMatrixIsTruncated)
+{
+    engine.setDisplayLimit(100);
+    eval("B = ones(1000, 10)");
+    EXPECT_NE(capturedOutput.find("more rows"), std::string::npos);
+    // 10 rows of 10 columns shown, not 1000.
+    EXPECT_LT(capturedOutput.size(), 2000u);
+}
+
+TEST_F(EngineDisplayBatchTest, SmallMatrixPrintsFully)
+{
+    eval("C = [1.5 2.5; 3.5 4.5]");
+    EXPECT_NE(capturedOutput.find("1.5"), std::string::npos);
+    EXPECT_NE(capturedOutput.find("4.5"), std::string::npos);
+    EXPECT_EQ(capturedOutput.find("more rows"), std::string::npos);
+}
+
+TEST_F(EngineDisplayBatchTest, FormattingMatchesGStyle)
+{
+    eval("x = 0.5");
+    EXPECT_NE(capturedOutput.find("0.5"), std::string::npos);
+    capturedOutput.clear();
+    eval("y = 1000000");
+    EXPECT_NE(capturedOutput.find("1e+06"), std::string::npos);
+}
+
+// ============================================================
+// Scalar-subscript indexing fast paths
+// ============================================================
+
+class EngineIndexFastPathTest : public EngineTest
+{};
+
+TEST_F(EngineIndexFastPathTest, ScalarLoopIndexingAllocatesNothing)
+{
+    size_t allocations = 0;
+    engine.setAllocator({[&allocations](size_t n) -> void * {
+                             ++allocations;
+                             return ::operator new(n);
+                         },
+                         [](void *p, size_t) { ::operator delete(p); }});
+    eval("A = rand(100); s = 0;");
+    size_t before = allocations;
+    eval("for i = 1:100 for j = 1:100 s = s + A(i, j); end end");
+    EXPECT_EQ(allocations - before, 0u);
+    eval("ok = abs(s - sum(A(:))) < 1e-9;");
+    EXPECT_TRUE(engine.getVariable("ok")->toBool());
+}
+
+TEST_F(EngineIndexFastPathTest, ScalarAssignLoop)
+{
+    eval("B = zeros(1, 1000); for k = 1:1000 B(k) = k * 2; end");
+    auto *b = getVarPtr("B");
+    EXPECT_DOUBLE_EQ((*b)(0), 2.0);
+    EXPECT_DOUBLE_EQ((*b)(999), 2000.0);
+}
+
+TEST_F(EngineIndexFastPathTest, BoundsAndValidationPreserved)
+{
+    eval("v = [1 2 3];");
+    EXPECT_THROW(eval("v(0);"), std::runtime_error);
+    EXPECT_THROW(eval("v(4);"), std::runtime_error);
+    EXPECT_THROW(eval("v(1.5);"), std::runtime_error);
+    eval("M = [1 2; 3 4];");
+    EXPECT_THROW(eval("M(3, 1);"), std::runtime_error);
+}
+
+TEST_F(EngineIndexFastPathTest, EndArithmeticStillWorks)
+{
+    eval("v = [10 20 30 40]; x = v(end - 1); y = v(end);");
+    EXPECT_DOUBLE_EQ(getVar("x"), 30.0);
+    EXPECT_DOUBLE_EQ(getVar("y"), 40.0);
+}
+
+TEST_F(EngineIndexFastPathTest, NonScalarIndexFallbackIntact)
+{
+    eval("v = [10 20 30 40]; p = v([4 1]); m = v(v > 15);");
+    EXPECT_DOUBLE_EQ((*getVarPtr("p"))(0), 40.0);
+    EXPECT_DOUBLE_EQ((*getVarPtr("p"))(1), 10.0);
+    EXPECT_EQ(getVarPtr("m")->numel(), 3u);
+}
+
+TEST_F(EngineIndexFastPathTest, LogicalArrayScalarIndex)
+{
+    eval("L = [1 0 1] > 0; a = L(2); b = L(3);");
+    EXPECT_FALSE(engine.getVariable("a")->toBool());
+    EXPECT_TRUE(engine.getVariable("b")->toBool());
+}
+
+// ============================================================
+// Function handle target binding / call-site caching
+// ============================================================
+
+class EngineHandleBindTest : public EngineTest
+{};
+
+TEST_F(EngineHandleBindTest, NamedBuiltinHandleBinds)
+{
+    eval("f = @sin;");
+    auto *f = getVarPtr("f");
+    EXPECT_EQ(f->handleOwner(), &engine);
+    EXPECT_GE(f->handleBuiltinId(), 0);
+    EXPECT_DOUBLE_EQ(evalScalar("f(0);"), 0.0);
+}
+
+TEST_F(EngineHandleBindTest, UserFunctionHandleBindsAndTracksRedefinition)
+{
+    eval(R"(
+        function r = scaleit(x)
+            r = x * 2;
+        end
+    )");
+    eval("h = @scaleit; a = h(5);");
+    EXPECT_DOUBLE_EQ(getVar("a"), 10.0);
+    // Redefinition replaces the map entry in place; the bound handle
+    // must see the new body.
+    eval(R"(
+        function r = scaleit(x)
+            r = x * 3;
+        end
+    )");
+    eval("b = h(5);");
+    EXPECT_DOUBLE_EQ(getVar("b"), 15.0);
+}
+
+TEST_F(EngineHandleBindTest, HandleToUndefinedNameStillLateBinds)
+{
+    eval("g = @definedlater;");
+    eval(R"(
+        function r = definedlater()
+            r = 7;
+        end
+    )");
+    EXPECT_DOUBLE_EQ(evalScalar("g();"), 7.0);
+}
+
+TEST_F(EngineHandleBindTest, RepeatedCallsThroughHandle)
+{
+    eval("h = @(x) x + 1; t = 0; for i = 1:1000 t = t + h(i); end");
+    EXPECT_DOUBLE_EQ(getVar("t"), 501500.0);
+}
+
+TEST_F(EngineHandleBindTest, NamedCallSiteCached)
+{
+    eval(R"(
+        function r = work(x)
+            r = x - 1;
+        end
+    )");
+    eval("t = 0; for i = 1:500 t = t + work(i); end");
+    EXPECT_DOUBLE_EQ(getVar("t"), 124750.0);
+}
+
+// ============================================================
+// String arrays
+// ============================================================
+
+class EngineStringArrayTest : public EngineTest
+{};
+
+TEST_F(EngineStringArrayTest, ConstructionFromCell)
+{
+    eval("s = string({'alpha', 'beta', 'gamma'});");
+    auto *s = getVarPtr("s");
+    ASSERT_TRUE(s->isStringArray());
+    EXPECT_EQ(s->numel(), 3u);
+    EXPECT_EQ(s->stringAt(1), "beta");
+    EXPECT_EQ(s->stringBytes(), 14u); // one pooled buffer
+}
+
+TEST_F(EngineStringArrayTest, VectorizedUpperLowerSharePool)
+{
+    eval("s = string({'Log', 'Warn'}); u = upper(s); l = lower(s);");
+    EXPECT_EQ(getVarPtr("u")->stringAt(0), "LOG");
+    EXPECT_EQ(getVarPtr("l")->stringAt(1), "warn");
+}
+
+TEST_F(EngineStringArrayTest, VectorizedStrcmp)
+{
+    eval("s = string({'err', 'ok', 'err'}); m = strcmp(s, 'err');");
+    auto *m = getVarPtr("m");
+    ASSERT_TRUE(m->isLogical());
+    EXPECT_EQ(m->logicalData()[0], 1);
+    EXPECT_EQ(m->logicalData()[1], 0);
+    EXPECT_EQ(m->logicalData()[2], 1);
+    eval("n = strcmp(s, string({'err', 'ok', 'no'}));");
+    EXPECT_EQ(getVarPtr("n")->logicalData()[2], 0);
+}
+
+TEST_F(EngineStringArrayTest, VectorizedStrtrim)
+{
+    eval("t = strtrim(string({'  a ', 'b', ' c'}));");
+    auto *t = getVarPtr("t");
+    EXPECT_EQ(t->stringAt(0), "a");
+    EXPECT_EQ(t->stringAt(2), "c");
+}
+
+TEST_F(EngineStringArrayTest, CellstrRoundTrip)
+{
+    eval("c = cellstr(string({'x', 'yy'}));");
+    auto *c = getVarPtr("c");
+    ASSERT_TRUE(c->isCell());
+    EXPECT_EQ(c->cellAt(1).toString(), "yy");
+}
+
+TEST_F(EngineStringArrayTest, CopyIsSharedUntilNothingMutates)
+{
+    eval("s = string({'one', 'two'}); t = s;");
+    EXPECT_EQ(getVarPtr("s")->pooledChars().data(), getVarPtr("t")->pooledChars().data());
+}
+
+TEST_F(EngineStringArrayTest, WorkspaceRoundTrip)
+{
+    eval("s = string({'persist', 'me'});");
+    engine.saveWorkspace("test_strings.mlabws");
+    Engine fresh;
+    fresh.loadWorkspace("test_strings.mlabws");
+    EXPECT_EQ(fresh.getVariable("s")->stringAt(0), "persist");
+    std::remove("test_strings.mlabws");
+}
+
+TEST_F(EngineViewTest, ScalarColonIndexingStaysScalar)
+{
+    eval("x = 5; y = x(:); z = x(:, 1);");
+    EXPECT_DOUBLE_EQ(getVar("y"), 5.0);
+    EXPECT_DOUBLE_EQ(getVar("z"), 5.0);
+}
+
+TEST_F(EngineReduceTest, EmptyInputsReturnEmpty)
+{
+    eval("a = sum([]); b = prod([]); c = mean([]); d = max([]); e = min([]);");
+    for (const char *name : {"a", "b", "c", "d", "e"}) {
+        auto *v = engine.getVariable(name);
+        ASSERT_NE(v, nullptr) << name;
+        EXPECT_TRUE(v->isEmpty()) << name;
+    }
+}
+
+TEST_F(EngineStringArrayTest, ElementIndexing)
+{
+    eval("s = string({'x', 'y', 'z'}); a = s(2); b = s([3 1]); c = s(end);");
+    auto *a = getVarPtr("a");
+    ASSERT_TRUE(a->isStringArray());
+    EXPECT_EQ(a->numel(), 1u);
+    EXPECT_EQ(a->stringAt(0), "y");
+    auto *b = getVarPtr("b");
+    EXPECT_EQ(b->stringAt(0), "z");
+    EXPECT_EQ(b->stringAt(1), "x");
+    EXPECT_EQ(getVarPtr("c")->stringAt(0), "z");
+    EXPECT_THROW(eval("s(4);"), std::runtime_error);
+}
+
+TEST_F(EngineStringArrayTest, EmptyEntriesConvert)
+{
+    eval("s = string({'', 'a', ''});");
+    auto *s = getVarPtr("s");
+    ASSERT_EQ(s->numel(), 3u);
+    EXPECT_EQ(s->stringAt(0), "");
+    EXPECT_EQ(s->stringAt(1), "a");
+    EXPECT_EQ(s->stringAt(2), "");
+}
+
+TEST_F(EngineIntegerTest, MixedClassComparisonThrows)
+{
+    EXPECT_THROW(eval("int64([1 2 3]) == int8([1 2 3]);"), std::runtime_error);
+    EXPECT_THROW(eval("int8([1 2 3]) < int64([1 2 3]);"), std::runtime_error);
+    // Same class and int-vs-double-scalar comparisons keep working.
+    eval("m = int8([1 2 3]) == int8([1 0 3]); n = int64([5 6]) > 5;");
+    EXPECT_EQ(getVarPtr("m")->logicalData()[1], 0);
+    EXPECT_EQ(getVarPtr("n")->logicalData()[1], 1);
+}
+
+TEST_F(EngineReduceTest, IntegerDimFormThrowsInsteadOfWrongShape)
+{
+    EXPECT_THROW(eval("max(int32([1 5; 3 2]), [], 1);"), std::runtime_error);
+    EXPECT_THROW(eval("min(int32([1 5; 3 2]), [], 2);"), std::runtime_error);
+    // Double dim form and integer whole-array max are unaffected.
+    eval("m = max([1 5; 3 2], [], 1); w = max(int32([1 5; 3 2]));");
+    EXPECT_DOUBLE_EQ((*getVarPtr("m"))(0), 3.0);
+    EXPECT_DOUBLE_EQ((*getVarPtr("m"))(1), 5.0);
+    EXPECT_DOUBLE_EQ(getVarPtr("w")->toScalar(), 5.0);
+}
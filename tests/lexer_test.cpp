@@ -1,4 +1,5 @@
 #include "MLabLexer.hpp"
+#include <deque>
 #include <gtest/gtest.h>
 
 using namespace mlab;
@@ -9,8 +10,11 @@ using namespace mlab;
 
 static std::vector<Token> lex(const std::string &src)
 {
-    Lexer lexer(src);
-    return lexer.tokenize();
+    // Token values are string_views into the Lexer, so the Lexer must
+    // outlive the tokens the assertions below inspect.
+    static std::deque<Lexer> lexers;
+    lexers.emplace_back(src);
+    return lexers.back().tokenize();
 }
 
 static void expectTokenTypes(const std::string &src, const std::vector<TokenType> &expected)
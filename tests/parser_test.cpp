@@ -1987,3 +1987,80 @@ TEST_F(ParserEdgeCaseTest, MatrixTransposeInExpression)
     EXPECT_EQ(expr.children[0]->type, NodeType::UNARY_OP);
     EXPECT_EQ(expr.children[0]->strValue, "'");
 }
+
+// ============================================================
+// ASTOptimizer — constant folding / dead branches
+// ============================================================
+
+#include "MLabOptimizer.hpp"
+
+static ASTNodePtr parseOptimized(const std::string &source)
+{
+    auto ast = parseSource(source);
+    ASTOptimizer::run(ast.get());
+    return ast;
+}
+
+TEST(Optimizer, FoldsLiteralArithmetic)
+{
+    auto ast = parseOptimized("x = 2 * 3 + 1;");
+    const auto &assign = stmt(*ast, 0);
+    ASSERT_EQ(assign.type, NodeType::ASSIGN);
+    const auto &rhs = *assign.children[1];
+    EXPECT_EQ(rhs.type, NodeType::NUMBER_LITERAL);
+    EXPECT_DOUBLE_EQ(rhs.numValue, 7.0);
+}
+
+TEST(Optimizer, FoldsUnaryMinus)
+{
+    auto ast = parseOptimized("x = -4 + 1;");
+    const auto &rhs = *stmt(*ast, 0).children[1];
+    EXPECT_EQ(rhs.type, NodeType::NUMBER_LITERAL);
+    EXPECT_DOUBLE_EQ(rhs.numValue, -3.0);
+}
+
+TEST(Optimizer, FoldsComparisonsToBool)
+{
+    auto ast = parseOptimized("x = 2 < 3;");
+    const auto &rhs = *stmt(*ast, 0).children[1];
+    EXPECT_EQ(rhs.type, NodeType::BOOL_LITERAL);
+    EXPECT_TRUE(rhs.boolValue);
+}
+
+TEST(Optimizer, LeavesNonConstantAlone)
+{
+    auto ast = parseOptimized("x = y * 2 + 1;");
+    const auto &rhs = *stmt(*ast, 0).children[1];
+    EXPECT_EQ(rhs.type, NodeType::BINARY_OP);
+}
+
+TEST(Optimizer, DropsConstantFalseBranch)
+{
+    auto ast = parseOptimized("if 0\n a = 1;\nelseif c\n a = 2;\nend");
+    const auto &ifNode = stmt(*ast, 0);
+    ASSERT_EQ(ifNode.type, NodeType::IF_STMT);
+    ASSERT_EQ(ifNode.branches.size(), 1u);
+    EXPECT_EQ(ifNode.branches[0].first->type, NodeType::IDENTIFIER);
+}
+
+TEST(Optimizer, ConstantTrueBranchPrunesRest)
+{
+    auto ast = parseOptimized("if 1\n a = 1;\nelseif c\n a = 2;\nelse\n a = 3;\nend");
+    const auto &ifNode = stmt(*ast, 0);
+    ASSERT_EQ(ifNode.type, NodeType::IF_STMT);
+    ASSERT_EQ(ifNode.branches.size(), 1u);
+    EXPECT_EQ(ifNode.elseBranch, nullptr);
+}
+
+TEST(Optimizer, FoldsInsideFunctionBodies)
+{
+    auto ast = parseOptimized("function y = f(x)\n y = x + 2 * 8;\nend");
+    const auto &fn = stmt(*ast, 0);
+    ASSERT_EQ(fn.type, NodeType::FUNCTION_DEF);
+    const auto &body = *fn.children[0];
+    const auto &assign = *body.children[0];
+    const auto &sum = *assign.children[1]; // x + 16
+    ASSERT_EQ(sum.type, NodeType::BINARY_OP);
+    EXPECT_EQ(sum.children[1]->type, NodeType::NUMBER_LITERAL);
+    EXPECT_DOUBLE_EQ(sum.children[1]->numValue, 16.0);
+}